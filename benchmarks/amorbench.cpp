@@ -0,0 +1,437 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amoranimation.h"
+#include "amorallocations.h"
+#include "amorengine.h"
+#include "amorpixmapmanager.h"
+#include "amorstats.h"
+#include "amorthememanager.h"
+#include "amortips.h"
+#include "amorwidget.h"
+#include "amorwindowsystem.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QSettings>
+#include <QtTest>
+
+// QBENCHMARK cases for the loading, per frame and painting code paths,
+// run against every theme in the data directory (AMOR_BENCH_DATA, or the
+// data/ directory of the source tree). The results are written by QtTest,
+// e.g. "amor-bench -o results.xml,xml" for a machine readable report.
+// Built with AMOR_COUNT_ALLOCATIONS, steadyTickAllocations fails if a
+// steady state frame tick of a shown creature allocates.
+
+#define STEADY_TICKS 100        // frame ticks per iteration of the steady tick case
+#define WARMUP_TICKS 5000       // ticks run before, to reach the steady state
+
+
+// Reads all groups of a theme like amor does, including those of added states
+static void loadTheme(AmorThemeManager &theme, const QString &file)
+{
+    theme.setTheme( file );
+
+    const int groups = theme.isStatic() ? 1 : AmorThemeManager::GroupCount;
+    for(int i = 0; i < groups; ++i) {
+        theme.readGroup( static_cast<AmorThemeManager::Group>( i ) );
+    }
+
+    const AmorBehaviour &behaviour = theme.behaviour();
+    for(int state = AmorBehaviour::BuiltinStateCount; state < behaviour.stateCount() && !theme.isStatic(); ++state) {
+        theme.readGroup( behaviour.group( state ), behaviour.stateName( state ) );
+    }
+}
+
+
+class BenchTips : public AmorTips
+{
+    public:
+        using AmorTips::read;
+};
+
+
+// A desktop with a single window which never changes
+class BenchWindowSystem : public AmorWindowSystem
+{
+    public:
+        WId activeWindow() const override { return 1; }
+        QRect frameGeometry(WId) const override { return QRect( 200, 300, 1200, 600 ); }
+        bool isMaximizedVertically(WId) const override { return false; }
+        bool isMinimized(WId) const override { return false; }
+        QRect workArea() const override { return QRect( 0, 0, 1920, 1080 ); }
+        QPoint cursorPos() const override { return QPoint(); }
+};
+
+
+// Fires the frame timer whenever it is asked to
+class BenchClock : public AmorClock
+{
+    public:
+        BenchClock() : mNow( 0 ) {}
+
+        qint64 elapsed() const override { return mNow; }
+        void start(int msec) override { mNow += msec; }
+        void stop() override {}
+        bool isActive() const override { return true; }
+
+        qint64 mNow;
+};
+
+
+// Shows the frames on a widget with the code amor uses. Tips and messages
+// are off, so the bubble check of Amor::showFrame() never passes.
+class BenchHost : public AmorEngine::Host
+{
+    public:
+        BenchHost() : mEngine( 0 ) {}
+
+        bool hasBubble() const override { return false; }
+        void dismissBubble() override {}
+        void targetChanged() override {}
+        void targetMoved() override {}
+        void hideCreature() override {}
+        void enteredState() override {}
+
+        void showFrame() override
+        {
+            mWidget.showAnimation( mEngine->animation(), mEngine->framePosition() );
+            if( !mWidget.isVisible() ) {
+                mWidget.show();
+            }
+        }
+
+        AmorEngine *mEngine;
+        AmorWidget mWidget;
+};
+
+
+// A creature which has settled on its window, ticked like Amor::slotTimeout()
+class BenchCreature
+{
+    public:
+        explicit BenchCreature(const QString &file)
+          : mEngine( &mWindows, &mClock, &mHost )
+        {
+            loadTheme( mTheme, file );
+            mHost.mEngine = &mEngine;
+            mEngine.setTheme( &mTheme );
+            mEngine.start();
+            for(int i = 0; i < WARMUP_TICKS; ++i) {
+                tick();
+                QCoreApplication::processEvents();
+            }
+        }
+
+        // Returns the heap allocations of the tick itself
+        qint64 tick()
+        {
+            const qint64 before = AmorAllocations::count();
+            {
+                AmorStats::Tick stats( mEngine.delay(), mEngine.delay() );
+                mEngine.tick();
+            }
+            return AmorAllocations::count() - before;
+        }
+
+    private:
+        AmorThemeManager mTheme;
+        BenchWindowSystem mWindows;
+        BenchClock mClock;
+        BenchHost mHost;
+        AmorEngine mEngine;
+};
+
+
+class AmorBench : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void initTestCase();
+
+        void themeLoad_data() { addThemes(); }
+        void themeLoad();
+        void pngDecode_data() { addThemes(); }
+        void pngDecode();
+        void maskHeuristic_data() { addThemes(); }
+        void maskHeuristic();
+        void maskAlpha_data() { addThemes(); }
+        void maskAlpha();
+        void frameDecode_data() { addThemes(); }
+        void frameDecode();
+        void animationAccessors_data() { addThemes(); }
+        void animationAccessors();
+        void widgetPaint_data() { addThemes(); }
+        void widgetPaint();
+        void steadyTick_data() { addThemes(); }
+        void steadyTick();
+        void steadyTickAllocations_data() { addThemes(); }
+        void steadyTickAllocations();
+        void tipsLoad();
+
+    private:
+        void addThemes();
+
+        static QStringList images(const QString &file);
+        static QList<AmorAnimation*> animations(const QString &file);
+
+        QDir mData;
+};
+
+
+void AmorBench::initTestCase()
+{
+    mData.setPath( qEnvironmentVariableIsEmpty( "AMOR_BENCH_DATA" ) ? QStringLiteral( AMOR_BENCH_DATA_DIR )
+                                                                    : qEnvironmentVariable( "AMOR_BENCH_DATA" ) );
+    QVERIFY2( !mData.entryList( QStringList() << QStringLiteral( "*rc" ), QDir::Files ).isEmpty(),
+              qPrintable( QStringLiteral( "No themes in %1" ).arg( mData.path() ) ) );
+}
+
+
+// One row per theme, named after it
+void AmorBench::addThemes()
+{
+    QTest::addColumn<QString>( "theme" );
+
+    const QStringList themes = mData.entryList( QStringList() << QStringLiteral( "*rc" ), QDir::Files, QDir::Name );
+    for(const QString &theme : themes) {
+        QTest::newRow( qPrintable( QFileInfo( theme ).completeBaseName() ) ) << mData.absoluteFilePath( theme );
+    }
+}
+
+
+// The image files used by the animations of a theme
+QStringList AmorBench::images(const QString &file)
+{
+    AmorThemeManager theme;
+    theme.setTheme( file );
+
+    QStringList paths;
+    QSettings config( file, QSettings::IniFormat );
+    const QStringList groups = config.childGroups();
+    for(const QString &group : groups) {
+        const QStringList sequence = config.value( group + QLatin1String( "/Sequence" ) ).toStringList();
+        for(const QString &image : sequence) {
+            paths.append( theme.pixmapPath() + QLatin1Char( '/' ) + image );
+        }
+    }
+    paths.removeDuplicates();
+
+    return paths;
+}
+
+
+// Every animation of a theme; the caller deletes them
+QList<AmorAnimation*> AmorBench::animations(const QString &file)
+{
+    AmorThemeManager theme;
+    theme.setTheme( file );
+
+    QList<AmorAnimation*> animations;
+    QSettings config( file, QSettings::IniFormat );
+    const QStringList groups = config.childGroups();
+    for(const QString &group : groups) {
+        config.beginGroup( group );
+        if( config.contains( QStringLiteral( "Sequence" ) ) ) {
+            animations.append( new AmorAnimation( &config, theme.pixmapPath() ) );
+        }
+        config.endGroup();
+    }
+
+    return animations;
+}
+
+
+void AmorBench::themeLoad()
+{
+    QFETCH( QString, theme );
+
+    // Each iteration releases all frames again, so every load decodes them.
+    QCOMPARE( AmorPixmapManager::manager()->frameCount(), 0 );
+    QBENCHMARK {
+        AmorThemeManager manager;
+        loadTheme( manager, theme );
+    }
+}
+
+
+void AmorBench::pngDecode()
+{
+    QFETCH( QString, theme );
+
+    const QStringList paths = images( theme );
+    QBENCHMARK {
+        for(const QString &path : paths) {
+            QImage image( path );
+        }
+    }
+}
+
+
+void AmorBench::maskHeuristic()
+{
+    QFETCH( QString, theme );
+
+    QList<QImage> frames;
+    const QStringList paths = images( theme );
+    for(const QString &path : paths) {
+        frames.append( QImage( path ) );
+    }
+
+    QBENCHMARK {
+        for(const QImage &image : qAsConst( frames )) {
+            image.createHeuristicMask();
+        }
+    }
+}
+
+
+void AmorBench::maskAlpha()
+{
+    QFETCH( QString, theme );
+
+    QList<QImage> frames;
+    const QStringList paths = images( theme );
+    for(const QString &path : paths) {
+        frames.append( QImage( path ) );
+    }
+
+    QBENCHMARK {
+        for(const QImage &image : qAsConst( frames )) {
+            image.convertToFormat( QImage::Format_ARGB32 ).createAlphaMask();
+        }
+    }
+}
+
+
+void AmorBench::frameDecode()
+{
+    QFETCH( QString, theme );
+
+    const QStringList paths = images( theme );
+    QBENCHMARK {
+        AmorFrameStore::Frame frame;
+        for(const QString &path : paths) {
+            AmorPixmapManager::decode( path, &frame );
+        }
+    }
+}
+
+
+void AmorBench::animationAccessors()
+{
+    QFETCH( QString, theme );
+
+    const QList<AmorAnimation*> anims = animations( theme );
+    QBENCHMARK {
+        for(AmorAnimation *animation : anims) {
+            animation->reset();
+            const QImage *shown = 0;
+            do {
+                const QImage *frame = animation->frame();
+                animation->hotspot();
+                animation->movement();
+                animation->delay();
+                animation->damage( shown );
+                shown = frame;
+            } while( animation->next() );
+        }
+    }
+    qDeleteAll( anims );
+}
+
+
+void AmorBench::widgetPaint()
+{
+    QFETCH( QString, theme );
+
+    const QList<AmorAnimation*> anims = animations( theme );
+    AmorWidget widget;
+    QImage canvas( 256, 256, QImage::Format_ARGB32_Premultiplied );
+    QBENCHMARK {
+        for(AmorAnimation *animation : anims) {
+            animation->reset();
+            do {
+                const QImage *frame = animation->frame();
+                if( frame ) {
+                    widget.resize( frame->size() );
+                }
+                widget.setFrame( frame, animation->damage( widget.frame() ) );
+                widget.render( &canvas );
+            } while( animation->next() );
+        }
+    }
+    widget.setFrame( 0 );
+    qDeleteAll( anims );
+}
+
+
+// The frame tick of a creature which has settled on its window, and the
+// paint of the shown widget that follows in the event loop
+void AmorBench::steadyTick()
+{
+    QFETCH( QString, theme );
+
+    BenchCreature creature( theme );
+    QBENCHMARK {
+        for(int i = 0; i < STEADY_TICKS; ++i) {
+            creature.tick();
+            QCoreApplication::processEvents();
+        }
+    }
+}
+
+
+// Like AmorStats, this counts the allocations of the ticks only: the paint
+// and the flush of the backing store happen later in the event loop and
+// are Qt's. The bubble, the overlay and restacking are not covered.
+void AmorBench::steadyTickAllocations()
+{
+    QFETCH( QString, theme );
+
+    if( !AmorAllocations::isEnabled() ) {
+        QSKIP( "Built without AMOR_COUNT_ALLOCATIONS" );
+    }
+
+    BenchCreature creature( theme );
+    qint64 allocations = 0;
+    for(int i = 0; i < STEADY_TICKS; ++i) {
+        allocations += creature.tick();
+        QCoreApplication::processEvents();
+    }
+    QCOMPARE( allocations, qint64( 0 ) );
+}
+
+
+void AmorBench::tipsLoad()
+{
+    const QString tips = mData.absoluteFilePath( QStringLiteral( "tips-en" ) );
+    QBENCHMARK {
+        BenchTips tipsList;
+        tipsList.read( tips );
+    }
+}
+
+
+QTEST_MAIN(AmorBench)
+
+#include "amorbench.moc"
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
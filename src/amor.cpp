@@ -17,12 +17,19 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 #include "amor.h"
-#include "amorpixmapmanager.h"
 #include "amorbubble.h"
 #include "amorwidget.h"
+#include "amoranimation.h"
+#include "amorpixmapmanager.h"
+#include "amoroverlay.h"
 #include "amordialog.h"
+#include "amoreventlog.h"
+#include "amorstartupprofile.h"
+#include "amorstats.h"
+#include "amortrace.h"
 #include "version.h"
 #include "amorthememanager.h"
+#include "amorthemeindex.h"
 #include "amoradaptor.h"
 #include "amor_debug.h"
 
@@ -31,61 +38,111 @@
 #include <time.h>
 
 #include <QDBusConnection>
+#include <QDBusMetaType>
 #include <QTimer>
 #include <QCursor>
 #include <QStandardPaths>
 #include <QApplication>
 #include <QMenu>
+#include <QRandomGenerator>
+#include <QImage>
+#include <QBackingStore>
+#include <QVariantList>
 
 #include <KLocalizedString>
 #include <KMessageBox>
 #include <KStartupInfo>
 #include <KWindowInfo>
 #include <KHelpMenu>
-#include <KRandom>
 #include <KAboutData>
 
 #include <xcb/xcb.h>
+#ifdef HAVE_XCB_RES
+#include <xcb/res.h>
+#endif
 #include <QX11Info>
 
+#include <cstdio>
+
 // #define DEBUG_AMOR
 
-#define SLEEP_TIMEOUT   180     // Animation sleeps after SLEEP_TIMEOUT seconds
-                                // of mouse inactivity.
-#define TIPS_FILE       "tips-en"  // Display tips in TIP_FILE-LANG, e.g "tips-en" (this is then translated using i18n() at runtime)
 #define TIP_FREQUENCY   20      // Frequency tips are displayed small == more often.
 
-#define BUBBLE_TIME_STEP 250
+#define BUBBLE_GRACE    500     // ms a bubble stays after the pointer left it
+
+bool Amor::mMemoryReport = false;
+
+
+// The pixels of the backing store of a top level widget
+static qint64 backingStoreBytes(const QWidget *widget)
+{
+    if( !widget || !widget->isWindow() || !widget->backingStore() ) {
+        return 0;
+    }
+
+    const QSize size = widget->backingStore()->size() * widget->devicePixelRatioF();
+    return qint64( size.width() ) * size.height() * 4;
+}
+
 
-// Standard animation groups
-#define ANIM_BASE       "Base"
-#define ANIM_NORMAL     "Sequences"
-#define ANIM_FOCUS      "Focus"
-#define ANIM_BLUR       "Blur"
-#define ANIM_DESTROY    "Destroy"
-#define ANIM_SLEEP      "Sleep"
-#define ANIM_WAKE       "Wake"
+// The X server memory of the pixmaps of this client, -1 if unknown
+static qint64 xPixmapBytes(WId window)
+{
+#ifdef HAVE_XCB_RES
+    if( QX11Info::isPlatformX11() && window ) {
+        xcb_connection_t *connection = QX11Info::connection();
+        const auto cookie = xcb_res_query_client_pixmap_bytes( connection, window );
+        xcb_res_query_client_pixmap_bytes_reply_t *reply = xcb_res_query_client_pixmap_bytes_reply( connection, cookie, nullptr );
+        if( reply ) {
+            const qint64 bytes = reply->bytes + ( qint64( reply->bytes_overflow ) << 32 );
+            free( reply );
+            return bytes;
+        }
+    }
+#else
+    Q_UNUSED( window );
+#endif
 
+    return -1;
+}
 
 
-Amor::Amor()
-  : mAmor( 0 ),
+
+Amor::Amor(const QString &theme, Amor *primary)
+  : QObject( primary ),
+    mWin( 0 ),
+    mAmor( 0 ),
+    mRetiredTheme( 0 ),
+    mEngine( &mWindowSystem, &mClock, this ),
+    mBubbleRemaining( 0 ),
+    mMenu( 0 ),
     mBubble( 0 ),
+    mBubbleWindow( 0 ),
+    mCompanionTheme( theme ),
+    mReplayer( 0 ),
     mForceHideAmorWidget( false )
 {
-    new AmorAdaptor( this );
-    QDBusConnection::sessionBus().registerObject( QLatin1String( "/Amor" ), this );
+    mEngine.setTheme( &mTheme );
+
+    // Only the primary creature is reachable over D-Bus; the companions
+    // listed in the configuration are owned by it.
+    if( isPrimary() ) {
+        AmorStartupProfile::Scope scope( "dbus-register" );
+        qDBusRegisterMetaType<AmorMessage>();
+        qDBusRegisterMetaType<AmorMessageList>();
+        new AmorAdaptor( this );
+        new StatsAdaptor( this );
+        QDBusConnection::sessionBus().registerObject( QLatin1String( "/Amor" ), this );
+    }
 
     if( !readConfig() ) {
-        exit(0);
-    }
+        if( isPrimary() ) {
+            exit(0);
+        }
 
-    mTargetWin   = 0;
-    mNextTarget  = 0;
-    mMenu        = 0;
-    mCurrAnim    = mBaseAnim;
-    mPosition    = -1;
-    mState       = Normal;
+        deleteLater();
+        return;
+    }
 
     mWin = KWindowSystem::self();
     connect(mWin, &KWindowSystem::activeWindowChanged, this, &Amor::slotWindowActivate);
@@ -95,30 +152,22 @@ Amor::Amor()
             this, &Amor::slotWindowChange);
     connect(mWin, &KWindowSystem::currentDesktopChanged, this, &Amor::slotDesktopChange);
 
-    mAmor = new AmorWidget;
-    connect( mAmor, SIGNAL(mouseClicked(QPoint)), SLOT(slotMouseClicked(QPoint)) );
-    connect( mAmor, SIGNAL(dragged(QPoint,bool)), SLOT(slotWidgetDragged(QPoint,bool)) );
-    mAmor->resize(mTheme.maximumSize());
+    createWidget();
 
-    mTimer = new QTimer( this );
-    connect( mTimer, SIGNAL(timeout()), SLOT(slotTimeout()) );
+    connect( &mClock, SIGNAL(timeout()), SLOT(slotTimeout()) );
 
     mStackTimer = new QTimer( this );
     connect( mStackTimer, SIGNAL(timeout()), SLOT(restack()) );
 
     mBubbleTimer = new QTimer( this );
+    mBubbleTimer->setSingleShot( true );
     connect( mBubbleTimer, SIGNAL(timeout()), SLOT(slotBubbleTimeout()) );
 
-    std::time( &mActiveTime );
-    mCursPos = QCursor::pos();
     mCursorTimer = new QTimer( this );
     connect( mCursorTimer, SIGNAL(timeout()), SLOT(slotCursorTimeout()) );
     mCursorTimer->start( 500 );
 
-    mNextTarget = mWin->activeWindow();
-    selectAnimation( Focus );
-    mTimer->setSingleShot( true );
-    mTimer->start( 0 );
+    mEngine.start();
 
     if( !QDBusConnection::sessionBus().connect( QStringLiteral( "org.freedesktop.ScreenSaver" ), QStringLiteral( "/ScreenSaver" ), QStringLiteral( "org.freedesktop.ScreenSaver" ),
             QStringLiteral( "ActiveChanged" ), this, SLOT(screenSaverStatusChanged(bool)) ) )
@@ -126,7 +175,10 @@ Amor::Amor()
         qCDebug(AMOR_LOG) << "Could not attach DBus signal: org.freedesktop.ScreenSaver.ActiveChanged()";
     }
 
-    KStartupInfo::appStarted();
+    if( isPrimary() ) {
+        createCompanions();
+        KStartupInfo::appStarted();
+    }
 }
 
 
@@ -134,7 +186,17 @@ Amor::~Amor()
 {
     delete mMenu;
     delete mAmor;
-    delete mBubble;
+    delete mBubbleWindow;
+    delete mRetiredTheme;
+}
+
+
+void Amor::slotLanguageChanged()
+{
+    // Swap the tips bundle, or translate the English tips again.
+    if( mConfig.mTips ) {
+        mTips.setLanguages( KLocalizedString::languages() );
+    }
 }
 
 
@@ -154,15 +216,14 @@ void Amor::screenSaverStopped()
     mAmor->show();
     mForceHideAmorWidget = false;
 
-    mTimer->setSingleShot( true );
-    mTimer->start( 0 );
+    mClock.start( 0 );
 }
 
 
 void Amor::screenSaverStarted()
 {
     mAmor->hide();
-    mTimer->stop();
+    mClock.stop();
     mForceHideAmorWidget = true;
 
     // GP: hide the bubble (if there's any) leaving any current message in the queue
@@ -172,134 +233,458 @@ void Amor::screenSaverStarted()
 
 void Amor::showTip(const QString &tip)
 {
-    if( mTipsQueue.count() < 5 && !mForceHideAmorWidget ) { // start dropping tips if the queue is too long
+    AMOR_TRACE_SCOPE( "Amor::showTip" );
+
+    if( !mForceHideAmorWidget ) {   // the queue drops tips if there are too many
         mTipsQueue.enqueue( QueueItem( QueueItem::Tip, tip ) );
     }
 
-    if( mState == Sleeping ) {
-        selectAnimation( Waking );        // Set waking immediatedly
-        mTimer->setSingleShot( true );
-        mTimer->start( 0 );
+    if( mEngine.activity() ) {
+        mClock.start( 0 );
     }
 }
 
 
 void Amor::showMessage( const QString &message , int msec )
 {
+    AMOR_TRACE_SCOPE( "Amor::showMessage" );
+
     // FIXME: What should be done about messages and tips while the screensaver is on?
     if( mForceHideAmorWidget ) {
         return; // do not show messages sent while in the screensaver
     }
 
-    mTipsQueue.enqueue( QueueItem( QueueItem::Talk, message, msec ) );
+    queueMessage( message, msec );
 
-    if( mState == Sleeping ) {
-        selectAnimation( Waking );      // Set waking immediatedly
-        mTimer->setSingleShot( true );
-        mTimer->start( 0 );
+    if( mEngine.activity() ) {
+        mClock.start( 0 );
     }
 }
 
 
+int Amor::showMessages(const AmorMessageList &messages)
+{
+    AMOR_TRACE_SCOPE( "Amor::showMessages" );
+
+    if( mForceHideAmorWidget ) {
+        return 0;
+    }
+
+    int accepted = 0;
+    for(const AmorMessage &message : messages) {
+        if( queueMessage( message.text, message.msec ) ) {
+            ++accepted;
+        }
+    }
+
+    // One wake up for the whole batch
+    if( accepted && mEngine.activity() ) {
+        mClock.start( 0 );
+    }
+
+    return accepted;
+}
+
+
+bool Amor::queueMessage(const QString &message, int msec)
+{
+    return mTipsQueue.enqueue( QueueItem( QueueItem::Talk, message, msec ) );
+}
+
+
+QVariantMap Amor::state() const
+{
+    const AmorBehaviour &behaviour = mTheme.behaviour();
+
+    QVariantMap state;
+    state[QStringLiteral( "state" )] = behaviour.stateName( mEngine.state() );
+    state[QStringLiteral( "sleeping" )] = mEngine.state() == AmorBehaviour::Sleeping;
+    state[QStringLiteral( "hidden" )] = mForceHideAmorWidget || !mAmor || !mAmor->isVisible();
+    state[QStringLiteral( "targetWindow" )] = qulonglong( mEngine.target() );
+    state[QStringLiteral( "theme" )] = mConfig.mTheme;
+    state[QStringLiteral( "bubble" )] = mBubble != 0;
+    if( mBubble && !mTipsQueue.isEmpty() ) {
+        state[QStringLiteral( "bubbleText" )] = mTipsQueue.head().text();
+    }
+    state[QStringLiteral( "queueDepth" )] = mTipsQueue.count();
+    return state;
+}
+
+
+int Amor::queueDepth() const
+{
+    return mTipsQueue.count();
+}
+
+
+QVariantMap Amor::stats() const
+{
+    QVariantMap map = AmorStats::stats()->toMap();
+    const QVariantMap queue = mTipsQueue.stats();
+    for(QVariantMap::const_iterator it = queue.constBegin(); it != queue.constEnd(); ++it) {
+        map.insert( it.key(), it.value() );
+    }
+
+    return map;
+}
+
+
+void Amor::resetStats()
+{
+    AmorStats::stats()->reset();
+    mTipsQueue.resetStats();
+}
+
+
+QVariantMap Amor::memoryReport() const
+{
+    QVariantMap report;
+
+    QVariantList creatures;
+    creatures.append( memoryUsage() );
+    const QList<Amor*> companions = findChildren<Amor*>( QString(), Qt::FindDirectChildrenOnly );
+    for(const Amor *companion : companions) {
+        creatures.append( companion->memoryUsage() );
+    }
+    report[QStringLiteral( "creatures" )] = creatures;
+
+    // Frames are shared between the creatures, so the cache is counted once.
+    const AmorPixmapManager *pixmaps = AmorPixmapManager::manager();
+    report[QStringLiteral( "frameCacheDecodedBytes" )] = pixmaps->decodedBytes();
+    report[QStringLiteral( "frameCacheMappedBytes" )] = pixmaps->mappedBytes();
+    report[QStringLiteral( "frameCacheMaskBytes" )] = pixmaps->maskBytes();
+
+    qint64 overlays = 0;
+    for(const AmorOverlay *overlay : AmorOverlay::overlays()) {
+        overlays += backingStoreBytes( overlay );
+    }
+    report[QStringLiteral( "overlayBackingStoreBytes" )] = overlays;
+
+    const qint64 xPixmaps = xPixmapBytes( mAmor ? mAmor->window()->winId() : 0 );
+    if( xPixmaps >= 0 ) {
+        report[QStringLiteral( "xPixmapBytes" )] = xPixmaps;
+    }
+
+    return report;
+}
+
+
+QVariantMap Amor::memoryUsage() const
+{
+    qint64 decoded = 0;
+    qint64 mapped = 0;
+    qint64 masks = 0;
+    const AmorPixmapManager *pixmaps = AmorPixmapManager::manager();
+    const QVector<const QImage*> frames = mTheme.frames();
+    for(const QImage *frame : frames) {
+        if( pixmaps->isMapped( frame ) ) {
+            mapped += frame->sizeInBytes();
+        }
+        else {
+            decoded += frame->sizeInBytes();
+        }
+        masks += pixmaps->maskBytes( frame );
+    }
+
+    const qint64 backingStores = backingStoreBytes( mAmor ) + backingStoreBytes( mBubbleWindow );
+
+    QVariantMap usage;
+    usage[QStringLiteral( "theme" )] = mConfig.mTheme;
+    usage[QStringLiteral( "frames" )] = frames.size();
+    usage[QStringLiteral( "decodedBytes" )] = decoded;
+    usage[QStringLiteral( "mappedBytes" )] = mapped;
+    usage[QStringLiteral( "maskBytes" )] = masks;
+    usage[QStringLiteral( "tipsBytes" )] = mTips.memoryUsage();
+    usage[QStringLiteral( "backingStoreBytes" )] = backingStores;
+    return usage;
+}
+
+
+void Amor::setMemoryReport(bool report)
+{
+    mMemoryReport = report;
+}
+
+
+void Amor::printMemoryReport()
+{
+    // Wait until every creature has been shown and has a backing store.
+    const QList<Amor*> companions = findChildren<Amor*>( QString(), Qt::FindDirectChildrenOnly );
+    if( !mAmor->isVisible() ) {
+        return;
+    }
+    for(const Amor *companion : companions) {
+        if( !companion->mAmor || !companion->mAmor->isVisible() ) {
+            return;
+        }
+    }
+
+    mMemoryReport = false;
+    const QVariantMap report = memoryReport();
+
+    std::printf( "%-20s %7s %10s %10s %10s %10s %10s\n", "theme (KiB)", "frames", "decoded", "mapped", "masks", "tips", "windows" );
+    for(const QVariant &entry : report.value( QStringLiteral( "creatures" ) ).toList()) {
+        const QVariantMap usage = entry.toMap();
+        std::printf( "%-20s %7d %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                     qPrintable( usage.value( QStringLiteral( "theme" ) ).toString() ),
+                     usage.value( QStringLiteral( "frames" ) ).toInt(),
+                     usage.value( QStringLiteral( "decodedBytes" ) ).toLongLong() / 1024.0,
+                     usage.value( QStringLiteral( "mappedBytes" ) ).toLongLong() / 1024.0,
+                     usage.value( QStringLiteral( "maskBytes" ) ).toLongLong() / 1024.0,
+                     usage.value( QStringLiteral( "tipsBytes" ) ).toLongLong() / 1024.0,
+                     usage.value( QStringLiteral( "backingStoreBytes" ) ).toLongLong() / 1024.0 );
+    }
+    std::printf( "%-20s %7d %10.1f %10.1f %10.1f\n", "frame cache (shared)",
+                 AmorPixmapManager::manager()->frameCount(),
+                 report.value( QStringLiteral( "frameCacheDecodedBytes" ) ).toLongLong() / 1024.0,
+                 report.value( QStringLiteral( "frameCacheMappedBytes" ) ).toLongLong() / 1024.0,
+                 report.value( QStringLiteral( "frameCacheMaskBytes" ) ).toLongLong() / 1024.0 );
+    std::printf( "overlay backing stores: %.1f KiB\n", report.value( QStringLiteral( "overlayBackingStoreBytes" ) ).toLongLong() / 1024.0 );
+    if( report.contains( QStringLiteral( "xPixmapBytes" ) ) ) {
+        std::printf( "X server pixmaps: %.1f KiB\n", report.value( QStringLiteral( "xPixmapBytes" ) ).toLongLong() / 1024.0 );
+    }
+    std::fflush( stdout );
+
+    QCoreApplication::exit( 0 );
+}
+
+
 void Amor::reset()
 {
     hideBubble();
-    mAmor->setPixmap( 0L ); // get rid of your old copy of the pixmap
+    mAmor->setFrame( 0L ); // get rid of your old copy of the frame
 
-    AmorPixmapManager::manager()->reset();
     mTips.reset();
 
     readConfig();
+    createWidget();
+    createCompanions();
 
-    mCurrAnim = mBaseAnim;
-    mPosition = mCurrAnim->hotspot().x();
-    mState = Normal;
+    mEngine.restart();
+}
 
-    mAmor->resize( mTheme.maximumSize() );
-    mCurrAnim->reset();
 
-    mTimer->setSingleShot( true );
-    mTimer->start( 0 );
+bool Amor::readConfig()
+{
+    readSettings();
+    applySettings();
+
+    if( mConfig.mTips ) {
+        AmorStartupProfile::Scope scope( "tips" );
+        mTips.setLanguages( KLocalizedString::languages() );
+    }
+
+    return loadTheme();
 }
 
 
-bool Amor::readConfig()
+void Amor::readSettings()
 {
     // Read user preferences
-    mConfig.read();
+    AmorConfig config;
+    {
+        AmorStartupProfile::Scope scope( "config" );
+        config.read();
+    }
 
-    if( mConfig.mTips ) {
-        mTips.setFile(QLatin1String( TIPS_FILE ) );
+    setSettings( config );
+}
+
+
+void Amor::setSettings(const AmorConfig &config)
+{
+    mConfig = config;
+
+    if( !isPrimary() ) {
+        // Companions only differ from the primary creature in their theme,
+        // and leave the random tips to it.
+        mConfig.mTheme = mCompanionTheme;
+        mConfig.mRandomTheme = false;
+        mConfig.mTips = false;
+    }
+}
+
+
+void Amor::applySettings()
+{
+    // Map the shared frames, if the administrator provides them.
+    AmorPixmapManager::manager()->setFrameStore( mConfig.mFrameStore );
+
+    if( mBubbleWindow ) {
+        mBubbleWindow->setBalloon( mConfig.mBalloon );
     }
+    mTipsQueue.setCapacity( mConfig.mQueueLength );
+    mTipsQueue.setOverflowPolicy( AmorMessageQueue::overflowPolicy( mConfig.mQueueOverflow ) );
+
+    mEngine.setOffset( mConfig.mOffset );
+    mEngine.setStaticPosition( mConfig.mStaticPos );
+}
+
 
+bool Amor::loadTheme()
+{
     // Select a random theme if user requested it
     if( mConfig.mRandomTheme ) {
-        QStringList files;
-        // Store relative paths into files to avoid storing absolute pathnames.
-        const QStringList dirs = QStandardPaths::standardLocations(QStandardPaths::AppDataLocation);;
-        for (const QString& dir : dirs) {
-            const QStringList fileNames = QDir(dir).entryList(QStringList() << QStringLiteral("*rc"));
-            for (const QString& file : fileNames) {
-                files.append(dir + QLatin1Char('/') + file);
-            }
-        }
-        if (files.isEmpty()) {
+        AmorStartupProfile::Scope scope( "theme-scan" );
+        const QVector<AmorThemeInfo> &themes = AmorThemeIndex::index()->themes();
+        if( themes.isEmpty() ) {
             return false;
         }
-        const int randomTheme = KRandom::random() % files.count();
-        mConfig.mTheme = files.at(randomTheme);
+        mConfig.mTheme = themes.at( QRandomGenerator::global()->bounded( themes.count() ) ).path;
+    }
+
+    // Read the new theme aside, so that the current one stays usable if it fails
+    AmorThemeManager *theme = new AmorThemeManager;
+    if( !readTheme( theme ) ) {
+        delete theme;
+        return false;
     }
 
+    // The widget may still show a frame of the old theme; keep its frames
+    // until showFrame() has replaced it. If no frame was shown since the
+    // last change, the widget still shows one of the theme retired then,
+    // and none of the theme replaced now.
+    mTheme.swap( *theme );
+    if( mRetiredTheme ) {
+        delete theme;
+    }
+    else {
+        mRetiredTheme = theme;
+    }
+
+    return true;
+}
+
+
+bool Amor::readTheme(AmorThemeManager *theme)
+{
     // read selected theme
-    if( !mTheme.setTheme( mConfig.mTheme ) ) {
+    if( !theme->setTheme( mConfig.mTheme ) ) {
         KMessageBox::error( 0, i18nc( "@info:status", "Error reading theme: %1", mConfig.mTheme ) );
         return false;
     }
 
-    if( !mTheme.isStatic() ) {
-        const char *groups[] = { ANIM_BASE, ANIM_NORMAL, ANIM_FOCUS, ANIM_BLUR, ANIM_DESTROY, ANIM_SLEEP, ANIM_WAKE, 0 };
-
-        // Read all the standard animation groups
-        for(int i = 0; groups[i]; ++i) {
-            if( !mTheme.readGroup(QLatin1String( groups[i] ) ) ) {
-                KMessageBox::error( 0, i18nc( "@info:status", "Error reading group: %1", QLatin1String( groups[i] ) ) );
-                return false;
-            }
+    // Read all the standard animation groups, or just the base of a static theme
+    AmorStartupProfile::Scope groupsScope( "groups" );
+    const int groups = theme->isStatic() ? 1 : AmorThemeManager::GroupCount;
+    for(int i = 0; i < groups; ++i) {
+        const AmorThemeManager::Group group = static_cast<AmorThemeManager::Group>( i );
+        if( !theme->readGroup( group ) ) {
+            KMessageBox::error( 0, i18nc( "@info:status", "Error reading group: %1", AmorThemeManager::groupName( group ) ) );
+            return false;
         }
     }
-    else {
-        if( !mTheme.readGroup(QLatin1String( ANIM_BASE ) ) ) {
-            KMessageBox::error( 0, i18nc( "@info:status", "Error reading group: %1", QLatin1String( ANIM_BASE ) ) );
+
+    // Read the groups of the states the theme adds to the built-in behaviour
+    const AmorBehaviour &behaviour = theme->behaviour();
+    for(int state = AmorBehaviour::BuiltinStateCount; state < behaviour.stateCount() && !theme->isStatic(); ++state) {
+        if( !theme->readGroup( behaviour.group( state ), behaviour.stateName( state ) ) ) {
+            KMessageBox::error( 0, i18nc( "@info:status", "Error reading group: %1", behaviour.stateName( state ) ) );
             return false;
         }
     }
 
-    // Get the base animation
-    mBaseAnim = mTheme.random(QLatin1String( ANIM_BASE ) );
-
     return true;
 }
 
 
+void Amor::createWidget()
+{
+    const bool overlay = mConfig.mOverlay && AmorOverlay::isSupported();
+
+    // The creatures sharing an overlay also share one frame timer
+    mClock.setShared( overlay );
+
+    if( mAmor && mAmor->isOverlay() == overlay ) {
+        return;
+    }
+
+    delete mAmor;
+    mAmor = new AmorWidget( overlay );
+    connect( mAmor, SIGNAL(mouseClicked(QPoint)), SLOT(slotMouseClicked(QPoint)) );
+    connect( mAmor, SIGNAL(dragged(QPoint,bool)), SLOT(slotWidgetDragged(QPoint,bool)) );
+    connect( mAmor, SIGNAL(languageChanged()), SLOT(slotLanguageChanged()) );
+}
+
+
+void Amor::createCompanions()
+{
+    if( !isPrimary() ) {
+        return;
+    }
+
+    // The companions share the frames of their themes with all other
+    // creatures through the pixmap manager, but keep their own animation
+    // state and target window.
+    qDeleteAll( findChildren<Amor*>( QString(), Qt::FindDirectChildrenOnly ) );
+    for(const QString &theme : qAsConst( mConfig.mCompanions )) {
+        Amor *companion = new Amor( theme, this );
+        if( mReplayer ) {
+            companion->replay( mReplayer );
+        }
+    }
+}
+
+
+void Amor::replay(AmorEventReplayer *replayer)
+{
+    // Take the window events and the window geometry from the log instead
+    // of the window manager, so that the recorded windows need not exist.
+    mReplayer = replayer;
+    if( mWin ) {
+        disconnect( mWin, 0, this, 0 );
+    }
+
+    connect( replayer, &AmorEventReplayer::activeWindowChanged, this, &Amor::slotWindowActivate );
+    connect( replayer, &AmorEventReplayer::windowRemoved, this, &Amor::slotWindowRemove );
+    connect( replayer, &AmorEventReplayer::stackingOrderChanged, this, &Amor::slotStackingChanged );
+    connect( replayer, &AmorEventReplayer::windowChanged, this, &Amor::slotWindowChange );
+    connect( replayer, &AmorEventReplayer::currentDesktopChanged, this, &Amor::slotDesktopChange );
+    mEngine.setWindowSystem( replayer );
+
+    const QList<Amor*> companions = findChildren<Amor*>( QString(), Qt::FindDirectChildrenOnly );
+    for(Amor *companion : companions) {
+        companion->replay( replayer );
+    }
+}
+
+
 void Amor::showBubble()
 {
+    AMOR_TRACE_SCOPE( "Amor::showBubble" );
+
     if( !mTipsQueue.isEmpty() ) {
-        if( !mBubble ) {
-            mBubble = new AmorBubble;
+        if( !mBubbleWindow ) {
+            mBubbleWindow = new AmorBubble;
+            mBubbleWindow->setBalloon( mConfig.mBalloon );
+            connect( mBubbleWindow, SIGNAL(hovered(bool)), SLOT(slotBubbleHovered(bool)) );
+            connect( mBubbleWindow, SIGNAL(clicked()), SLOT(slotBubbleTimeout()) );
         }
+        mBubble = mBubbleWindow;
 
-        mBubble->setOrigin( mAmor->x()+mAmor->width()/2, mAmor->y()+mAmor->height()/2 );
+        const QRect rect = mAmor->globalGeometry();
+        mBubble->setOrigin( rect.x()+rect.width()/2, rect.y()+rect.height()/2 );
         mBubble->setMessage( mTipsQueue.head().text() );
-
-        // mBubbleTimer->start(mTipsQueue.head().time(), true);
-        mBubbleTimer->setSingleShot(true);
-        mBubbleTimer->start(BUBBLE_TIME_STEP);
+        mTipsQueue.setHeadShown( true );
+        emit bubbleShown( mTipsQueue.head().text() );
+
+        // One wake up when the message has been shown long enough; the
+        // clock only runs while the pointer is outside the bubble.
+        if( mBubble->mouseWithin() ) {
+            mBubbleTimer->stop();
+            mBubbleRemaining = mTipsQueue.head().time();
+        }
+        else {
+            startBubbleDeadline( mTipsQueue.head().time() );
+        }
     }
 }
 
 
 void Amor::hideBubble(bool forceDequeue)
 {
+    AMOR_TRACE_SCOPE( "Amor::hideBubble" );
+
     if( mBubble ) {
         // GP: stop mBubbleTimer to avoid deleting the first element, just in case we are changing windows
         // or something before the tip was shown long enough
@@ -316,156 +701,109 @@ void Amor::hideBubble(bool forceDequeue)
             /* there's always an item in the queue here */
             mTipsQueue.dequeue();
         }
+        else {
+            mTipsQueue.setHeadShown( false );
+        }
 
-        delete mBubble;
+        mBubble->hide();    // the window is shown again for the next message
         mBubble = 0;
+        emit bubbleDismissed();
     }
 }
 
 
-void Amor::selectAnimation(State state)
+bool Amor::hasBubble() const
 {
-    bool changedLocation = true;
-    AmorAnimation *oldAnim = mCurrAnim;
+    return mBubble != 0;
+}
 
-    switch( state ) {
-    case Blur:
-        hideBubble();
-        mCurrAnim = mTheme.random(QLatin1String( ANIM_BLUR ) );
-        mState = Focus;
-        break;
 
-    case Focus:
-        hideBubble();
-        mCurrAnim = mTheme.random(QLatin1String( ANIM_FOCUS ) );
-        if( oldAnim != mCurrAnim ) {
-            mCurrAnim->reset();
-        }
+void Amor::dismissBubble()
+{
+    hideBubble();
+}
 
-        mTargetWin = mNextTarget;
-
-        if( mTargetWin != XCB_NONE ) {
-            KWindowInfo windowInfo( mTargetWin, NET::WMFrameExtents | NET::WMState );
-            mTargetRect = windowInfo.frameGeometry();
-
-            // if the animation falls outside of the working area,
-            // then relocate it so that is inside the desktop again
-            QRect desktopArea = mWin->workArea(KWindowSystem::currentDesktop());
-            KWindowSystem::setOnDesktop(mAmor->winId(), KWindowSystem::currentDesktop());
-
-            bool fitsInWorkArea = mTargetRect.y() - mCurrAnim->hotspot().y() + mConfig.mOffset < desktopArea.y();
-            if( windowInfo.hasState(NET::MaxVert) || fitsInWorkArea ) {
-                if( mInDesktopBottom ) {
-                    changedLocation = false;
-                }
-
-                // relocate the animation at the bottom of the screen
-                mTargetRect = QRect( desktopArea.x(), desktopArea.y() + desktopArea.height(), desktopArea.width(), 0 );
-
-                // we'll relocate the animation in the desktop
-                // frame, so do not add the offset to its vertical position
-                mInDesktopBottom = true;
-            }
-            else {
-                mInDesktopBottom = false;
-            }
-
-            if( mTheme.isStatic() ) {
-                if( mConfig.mStaticPos < 0 ) {
-                    mPosition = mTargetRect.width() + mConfig.mStaticPos;
-                }
-                else {
-                    mPosition = mConfig.mStaticPos;
-                }
-
-                if( mPosition >= mTargetRect.width() ) {
-                    mPosition = mTargetRect.width()-1;
-                }
-                else if( mPosition < 0 ) {
-                    mPosition = 0;
-                }
-            }
-            else {
-                if( mCurrAnim->frame() ) {
-                    if( mTargetRect.width() == mCurrAnim->frame()->width() ) {
-                        mPosition = mCurrAnim->hotspot().x();
-                    }
-                    else if(changedLocation || mPosition < 0) {
-                        mPosition = KRandom::random() % ( mTargetRect.width() - mCurrAnim->frame()->width() );
-                        mPosition += mCurrAnim->hotspot().x();
-                    }
-                }
-                else {
-                    mPosition = mTargetRect.width()/2;
-                }
-            }
-        }
-        else {
-            // We don't want to do anything until a window comes into focus.
-            mTimer->stop();
-        }
-        mAmor->hide();
+
+void Amor::showFrame()
+{
+    AmorAnimation *anim = mEngine.animation();
+    mAmor->showAnimation( anim, mEngine.framePosition() );
+
+    // Nothing shows the frames of the previous theme any more.
+    delete mRetiredTheme;
+    mRetiredTheme = 0;
+
+    if( !mAmor->isVisible() ) {
+        mAmor->show();
+        AmorStats::stats()->xRequests();
         restack();
-        mState = Normal;
-        break;
-
-    case Destroy:
-        hideBubble();
-        mCurrAnim = mTheme.random(QLatin1String( ANIM_DESTROY ) );
-        mState = Focus;
-        break;
-
-    case Sleeping:
-        mCurrAnim = mTheme.random(QLatin1String( ANIM_SLEEP ) );
-        break;
-
-    case Waking:
-        mCurrAnim = mTheme.random(QLatin1String( ANIM_WAKE ) );
-        mState = Normal;
-        break;
-
-    default:
-        // Select a random normal animation if the current animation
-        // is not the base, otherwise select the base.  This makes us
-        // alternate between the base animation and a random animination.
-        if( !mBubble && mCurrAnim == mBaseAnim ) {
-            mCurrAnim = mTheme.random(QLatin1String( ANIM_NORMAL ) );
+    }
+
+    if( anim == mEngine.baseAnimation() && anim->validFrame() ) {
+        // GP: Application tips/messages can be shown in any frame number; amor tips are
+        // only displayed on the first frame of mBaseAnim (the old way of doing this).
+        if( !mTipsQueue.isEmpty() && !mBubble &&  mConfig.mAppTips ) {
+            showBubble();
         }
-        else {
-            mCurrAnim = mBaseAnim;
+        else if( mConfig.mTips && !mBubble && !anim->frameNum() && QRandomGenerator::global()->bounded( TIP_FREQUENCY ) == 1 ) {
+            // The tip text is only looked up once one is actually shown.
+            mTipsQueue.enqueue( QueueItem( QueueItem::Tip, mTips.tip() ) );
+            showBubble();
         }
-        break;
     }
+}
 
-    if( mCurrAnim->totalMovement() + mPosition > mTargetRect.width() || mCurrAnim->totalMovement() + mPosition < 0 ) {
-        // The selected animation would end outside of this window's width
-        // We could randomly select a different one, but I prefer to just
-        // use the default animation.
-        mCurrAnim = mBaseAnim;
-    }
 
-    if( changedLocation ) {
-        mCurrAnim->reset();
-    }
-    else {
-        mCurrAnim = oldAnim;
+void Amor::targetChanged()
+{
+    if( mEngine.target() && !mAmor->isOverlay() ) {
+        KWindowSystem::setOnDesktop( mAmor->winId(), KWindowSystem::currentDesktop() );
+        AmorStats::stats()->xRequests();
     }
+
+    mAmor->hide();
+    AmorStats::stats()->xRequests();
+    restack();
+
+    emit targetWindowChanged( mEngine.target() );
+}
+
+
+void Amor::enteredState()
+{
+    emit stateChanged( mTheme.behaviour().stateName( mEngine.state() ) );
+}
+
+
+void Amor::targetMoved()
+{
+    hideBubble();
+    mAmor->moveGlobal( mEngine.framePosition() );
+}
+
+
+void Amor::hideCreature()
+{
+    mAmor->hide();
 }
 
 
 void Amor::restack()
 {
-    if( mTargetWin == XCB_NONE ) {
+    AMOR_TRACE_SCOPE( "Amor::restack" );
+
+    if( mEngine.target() == XCB_NONE ) {
         return;
     }
 
-    if( mConfig.mOnTop ) {
-        // simply raise the widget to the top
+    if( mConfig.mOnTop || mAmor->isOverlay() ) {
+        // simply raise the widget to the top; the overlay always stays on top
+        // and raising the widget only orders it among the other creatures
         mAmor->raise();
         return;
     }
 
-    xcb_window_t sibling = mTargetWin;
+    xcb_window_t sibling = mEngine.target();
     xcb_window_t dw, parent = XCB_NONE, *wins;
 
     do {
@@ -474,6 +812,7 @@ void Amor::restack()
         // We must use the target window's parent as our sibling.
         // Is there a faster way to get parent window than XQueryTree?
         const auto cookie = xcb_query_tree(QX11Info::connection(), sibling);
+        AmorStats::stats()->xRequests();
         const auto reply = xcb_query_tree_reply(QX11Info::connection(), cookie, nullptr);
         if (!reply) {
             return;
@@ -496,16 +835,17 @@ void Amor::restack()
     xcb_configure_window(QX11Info::connection(), mAmor->winId(),
                          XCB_CONFIG_WINDOW_SIBLING | XCB_CONFIG_WINDOW_STACK_MODE,
                          values);
+    AmorStats::stats()->xRequests();
 }
 
 
 void Amor::slotMouseClicked(const QPoint &pos)
 {
-    bool restartTimer = mTimer->isActive();
+    bool restartTimer = mClock.isActive();
 
     // Stop the animation while the menu is open.
     if( restartTimer ) {
-        mTimer->stop();
+        mClock.stop();
     }
 
     if( !mMenu ) {
@@ -528,85 +868,50 @@ void Amor::slotMouseClicked(const QPoint &pos)
     mMenu->exec( pos );
 
     if( restartTimer ) {
-        mTimer->setSingleShot( true );
-        mTimer->start( 1000 );
+        mClock.start( 1000 );
     }
 }
 
 
 void Amor::slotCursorTimeout()
 {
-    QPoint currPos = QCursor::pos();
-    QPoint diff = currPos - mCursPos;
-    std::time_t now = std::time( 0 );
-
     if( mForceHideAmorWidget ) {
         return; // we're hidden, do nothing
     }
 
-    if( abs( diff.x() ) > 1 || abs( diff.y() ) > 1 ) {
-        if( mState == Sleeping ) {
-            // Set waking immediatedly
-            selectAnimation( Waking );
-        }
-        mActiveTime = now;
-        mCursPos = currPos;
-    }
-    else if( mState != Sleeping && now - mActiveTime > SLEEP_TIMEOUT ) {
-        // GP: can't go to sleep if there are tips in the queue
-        if( mTipsQueue.isEmpty() ) {
-            mState = Sleeping;	// The next animation will become sleeping
-        }
-    }
+    // GP: can't go to sleep if there are tips in the queue
+    mEngine.pollActivity( mTipsQueue.isEmpty() );
 }
 
 
 void Amor::slotTimeout()
 {
+    AMOR_TRACE_SCOPE( "Amor::slotTimeout" );
+
     if( mForceHideAmorWidget ) {
+        mClock.stop();      // the frame timer repeats
         return;
     }
 
-    if( !mTheme.isStatic() ) {
-        mPosition += mCurrAnim->movement();
-    }
+    const auto tick = [this]() {
+        AmorStats::Tick stats( mClock.interval(), mClock.actualInterval() );
+        mEngine.tick();
+    };
 
-    mAmor->setPixmap( mCurrAnim->frame() );
-    mAmor->move( mTargetRect.x() + mPosition - mCurrAnim->hotspot().x(),
-                 mTargetRect.y() - mCurrAnim->hotspot().y() + ( !mInDesktopBottom?mConfig.mOffset:0 ) );
-
-    if( !mAmor->isVisible() ) {
-        mAmor->show();
-        restack();
-    }
-
-    if( mCurrAnim == mBaseAnim && mCurrAnim->validFrame() ) {
-        // GP: Application tips/messages can be shown in any frame number; amor tips are
-        // only displayed on the first frame of mBaseAnim (the old way of doing this).
-        if( !mTipsQueue.isEmpty() && !mBubble &&  mConfig.mAppTips ) {
-            showBubble();
-        }
-        else if( KRandom::random()%TIP_FREQUENCY == 1 && mConfig.mTips && !mBubble && !mCurrAnim->frameNum() ) {
-            mTipsQueue.enqueue( QueueItem( QueueItem::Tip, mTips.tip() ) );
-            showBubble();
-        }
-    }
-
-    if( mTheme.isStatic() ) {
-        mTimer->setSingleShot( true );
-        mTimer->start( ( mState == Normal ) || ( mState == Sleeping ) ? 1000 : 100 );
+    // Only the ticks until the first frame are profiled
+    if( AmorStartupProfile::profile()->isActive() ) {
+        AmorStartupProfile::Scope scope( "ticks" );
+        tick();
     }
     else {
-        mTimer->setSingleShot( true );
-        mTimer->start( mCurrAnim->delay() );
+        tick();
     }
 
-    if( !mCurrAnim->next() ) {
-        if( mBubble ) {
-            mCurrAnim->reset();
-        }
-        else {
-            selectAnimation( mState );
+    if( mAmor->isVisible() ) {
+        AmorStartupProfile::profile()->firstFrame();
+
+        if( mMemoryReport ) {
+            ( isPrimary() ? this : static_cast<Amor*>( parent() ) )->printMemoryReport();
         }
     }
 }
@@ -614,114 +919,151 @@ void Amor::slotTimeout()
 
 void Amor::slotConfigure()
 {
+    // The configuration is shared by all creatures; the primary creature
+    // applies the changes and passes them on to its companions.
+    Amor *primary = isPrimary() ? this : static_cast<Amor*>( parent() );
+
     AmorDialog *mAmorDialog = new AmorDialog();
-    connect( mAmorDialog, SIGNAL(changed()), SLOT(slotConfigChanged()) );
+    connect( mAmorDialog, SIGNAL(changed(AmorConfig)), primary, SLOT(slotConfigChanged(AmorConfig)) );
     connect( mAmorDialog, SIGNAL(offsetChanged(int)), SLOT(slotOffsetChanged(int)) );
     mAmorDialog->show();
 }
 
 
-void Amor::slotConfigChanged()
+void Amor::slotActivateRequested()
 {
-    reset();
+    // Starting amor again opens the configuration dialog, which is the only
+    // way to reach it when the creature is drawn in an input-transparent
+    // overlay. Otherwise the creature's menu is there for it.
+    if( mAmor && mAmor->isOverlay() ) {
+        slotConfigure();
+    }
+}
+
+
+void Amor::slotConfigChanged(const AmorConfig &config)
+{
+    // Only apply what the dialog changed: reading a theme again and
+    // recreating the windows is by far the most expensive part of a reset.
+    // The dialog passes its settings, as they may not be saved yet.
+    const AmorConfig previous = mConfig;
+    setSettings( config );
+    applySettings();
+
+    if( mConfig.mTips != previous.mTips ) {
+        if( mConfig.mTips ) {
+            mTips.setLanguages( KLocalizedString::languages() );
+        }
+        else {
+            mTips.reset();
+        }
+    }
+
+    // A random theme is only picked again when it was just switched on.
+    const bool themeChanged = mConfig.mRandomTheme ? !previous.mRandomTheme
+                                                   : ( previous.mRandomTheme || mConfig.mTheme != previous.mTheme );
+    bool restart = false;
+    if( themeChanged ) {
+        if( loadTheme() ) {
+            restart = true;
+        }
+        else {
+            mConfig.mTheme = previous.mTheme;
+        }
+    }
+    else if( mConfig.mRandomTheme ) {
+        mConfig.mTheme = previous.mTheme;
+    }
+
+    const AmorWidget *widget = mAmor;
+    createWidget();
+    if( mAmor != widget ) {
+        restart = true;
+    }
+
+    if( restart ) {
+        mEngine.restart();
+    }
+    else if( mConfig.mOnTop != previous.mOnTop ) {
+        restack();
+    }
+
+    if( !isPrimary() ) {
+        return;
+    }
+
+    if( mConfig.mCompanions != previous.mCompanions ) {
+        createCompanions();
+    }
+    else {
+        const QList<Amor*> companions = findChildren<Amor*>( QString(), Qt::FindDirectChildrenOnly );
+        for(Amor *companion : companions) {
+            companion->slotConfigChanged( config );
+        }
+    }
 }
 
 
 void Amor::slotOffsetChanged(int off)
 {
     mConfig.mOffset = off;
+    mEngine.setOffset( off );
 
-    if( mCurrAnim->frame() ) {
-        mAmor->move( mPosition + mTargetRect.x() - mCurrAnim->hotspot().x(),
-                     mTargetRect.y() - mCurrAnim->hotspot().y() + ( !mInDesktopBottom ? mConfig.mOffset : 0 ) );
+    if( mEngine.animation()->frame() ) {
+        mAmor->moveGlobal( mEngine.framePosition() );
     }
 }
 
 
 void Amor::slotWidgetDragged(const QPoint &delta, bool release)
 {
-    mTimer->stop();
+    mClock.stop();
 
-    if( mCurrAnim->frame() ) {
-        int newPosition = mPosition + delta.x();
-
-        if( mCurrAnim->totalMovement() + newPosition > mTargetRect.width() ) {
-            newPosition = mTargetRect.width() - mCurrAnim->totalMovement();
-        }
-        else if( mCurrAnim->totalMovement() + newPosition < 0 ) {
-            newPosition = -mCurrAnim->totalMovement();
-        }
-
-        mPosition = newPosition;
-        mAmor->move( mTargetRect.x() + mPosition - mCurrAnim->hotspot().x(), mAmor->y() );
+    if( mEngine.animation()->frame() ) {
+        mEngine.dragBy( delta.x() );
+        mAmor->moveGlobal( QPoint( mEngine.framePosition().x(), mAmor->globalGeometry().y() ) );
 
         if( mTheme.isStatic() && release ) {
             // static animations save the new position as preferred.
-            int savePos = mPosition;
-            if( savePos > mTargetRect.width()/2 ) {
-                savePos -= (mTargetRect.width()+1);
-            }
-            mConfig.mStaticPos = savePos;
-            mConfig.write();
+            // mConfig may hold the theme of a companion or a random one, so
+            // only the position is changed in the saved settings.
+            mConfig.mStaticPos = mEngine.staticPosition();
+            mEngine.setStaticPosition( mConfig.mStaticPos );
+            AmorConfig saved;
+            saved.read();
+            saved.mStaticPos = mConfig.mStaticPos;
+            saved.write();
         }
     }
 
     if (release) {
-        mTimer->setSingleShot( true );
-        mTimer->start( 0 );
+        mClock.start( 0 );
     }
 }
 
 
 void Amor::slotWindowActivate(WId win)
 {
-    mTimer->stop();
-    mNextTarget = win;
+    AMOR_TRACE_SCOPE( "Amor::slotWindowActivate" );
 
-    // This is an active event that affects the target window
-    std::time( &mActiveTime );
-
-    // A window gaining focus implies that the current window has lost
-    // focus.  Initiate a blur event if there is a current active window.
-    if( mTargetWin ) {
-        // We are losing focus from the current window
-        mTimer->setSingleShot( true );
-        mTimer->start( 0 );
-        selectAnimation( Destroy );
-    }
-    else if( mNextTarget ) {
-        // We are setting focus to a new window
-        if( mState != Focus ) {
-            selectAnimation( Focus );
-        }
-        mTimer->setSingleShot( true );
-        mTimer->start( 0 );
-    }
-    else {
-        // No action - We can get this when we switch between two empty desktops
-        mAmor->hide();
-    }
+    mEngine.windowActivated( win );
 }
 
 
 void Amor::slotWindowRemove(WId win)
 {
-    if( win == mTargetWin ) {
-        // This is an active event that affects the target window
-        std::time( &mActiveTime );
+    AMOR_TRACE_SCOPE( "Amor::slotWindowRemove" );
 
-        selectAnimation( Destroy );
-        mTimer->stop();
-        mTimer->setSingleShot( true );
-        mTimer->start( 0 );
-    }
+    mEngine.windowRemoved( win );
 }
 
 
 void Amor::slotStackingChanged()
 {
+    AMOR_TRACE_SCOPE( "Amor::slotStackingChanged" );
+
     // This is an active event that affects the target window
-    std::time( &mActiveTime );
+    mEngine.markActive();
 
     // We seem to get this signal before the window has been restacked,
     // so we just schedule a restack.
@@ -732,106 +1074,33 @@ void Amor::slotStackingChanged()
 
 void Amor::slotWindowChange(WId win, NET::Properties properties, NET::Properties2 properties2)
 {
-    if( win != mTargetWin ) {
-        return;
-    }
-
-    // This is an active event that affects the target window
-    std::time( &mActiveTime );
-
-    KWindowInfo windowInfo( mTargetWin, NET::WMFrameExtents );
-    NET::MappingState mappingState = windowInfo.mappingState();
-
-    if( mappingState == NET::Iconic || mappingState == NET::Withdrawn ) {
-        // The target window has been iconified
-        selectAnimation( Destroy );
-        mTargetWin = XCB_NONE;
-        mTimer->stop();
-        mTimer->setSingleShot( true );
-        mTimer->start( 0 );
-
-        return;
-    }
-
-    if( properties & NET::WMGeometry ) {
-        QRect newTargetRect = windowInfo.frameGeometry();
-
-        // if the change in the window caused the animation to fall
-        // out of the working area of the desktop, or if the animation
-        // didn't fall in the working area before but it does now, then
-        //  refocus on the current window so that the animation is
-        // relocated.
-        QRect desktopArea = mWin->workArea();
-
-        bool fitsInWorkArea = !( newTargetRect.y() - mCurrAnim->hotspot().y() + mConfig.mOffset < desktopArea.y() );
-        if( ( !fitsInWorkArea && !mInDesktopBottom ) || ( fitsInWorkArea && mInDesktopBottom ) ) {
-            mNextTarget = mTargetWin;
-            selectAnimation( Blur );
-            mTimer->setSingleShot( true );
-            mTimer->start( 0 );
-
-            return;
-        }
+    AMOR_TRACE_SCOPE( "Amor::slotWindowChange" );
 
-        if( !mInDesktopBottom ) {
-            mTargetRect = newTargetRect;
-        }
-
-        // make sure the animation is still on the window.
-        if( mCurrAnim->frame() ) {
-            hideBubble();
-            if( mTheme.isStatic() ) {
-                if( mConfig.mStaticPos < 0 ) {
-                    mPosition = mTargetRect.width() + mConfig.mStaticPos;
-                }
-                else {
-                    mPosition = mConfig.mStaticPos;
-                }
-
-                if( mPosition >= mTargetRect.width() ) {
-                    mPosition = mTargetRect.width()-1;
-                }
-                else if( mPosition < 0 ) {
-                    mPosition = 0;
-                }
-            }
-            else if( mPosition > mTargetRect.width() - ( mCurrAnim->frame()->width() - mCurrAnim->hotspot().x() ) ) {
-                mPosition = mTargetRect.width() - ( mCurrAnim->frame()->width() - mCurrAnim->hotspot().x() );
-            }
-            mAmor->move( mTargetRect.x() + mPosition - mCurrAnim->hotspot().x(),
-                         mTargetRect.y() - mCurrAnim->hotspot().y() + ( !mInDesktopBottom ? mConfig.mOffset : 0 ) );
-        }
-    }
+    mEngine.windowChanged( win, properties & NET::WMGeometry );
 }
 
 
 void Amor::slotDesktopChange(int desktop)
 {
-    mNextTarget = XCB_NONE;
-    mTargetWin = XCB_NONE;
-    selectAnimation( Normal );
-    mTimer->stop();
-    mAmor->hide();
+    AMOR_TRACE_SCOPE( "Amor::slotDesktopChange" );
+
+    mEngine.desktopChanged();
 }
 
 
 void Amor::slotBubbleTimeout()
 {
-    // has the queue item been displayed for long enough?
-    QueueItem &first = mTipsQueue.head();
+    AMOR_TRACE_SCOPE( "Amor::slotBubbleTimeout" );
 
-    if( first.time() > BUBBLE_TIME_STEP && mBubble->isVisible() ) {
-        first.setTime( first.time() - BUBBLE_TIME_STEP );
-        mBubbleTimer->setSingleShot( true );
-        mBubbleTimer->start( BUBBLE_TIME_STEP );
+    if( !mBubble ) {
         return;
     }
+    mBubbleTimer->stop();
 
-    // do not do anything if the mouse pointer is in the bubble
-    if( mBubble->mouseWithin() ) {
-        first.setTime( 500 );                  // show this item for another 500ms
-        mBubbleTimer->setSingleShot( true );
-        mBubbleTimer->start( BUBBLE_TIME_STEP );
+    // do not do anything if the mouse pointer is in the bubble; leaving it
+    // restarts the clock
+    if( mBubble->mouseWithin() && mBubble->isVisible() ) {
+        mBubbleRemaining = BUBBLE_GRACE;
         return;
     }
 
@@ -846,5 +1115,31 @@ void Amor::slotBubbleTimeout()
 }
 
 
+void Amor::slotBubbleHovered(bool within)
+{
+    if( !mBubble || !mBubble->isVisible() ) {
+        return;
+    }
+
+    if( within ) {
+        // Pause: keep what is left until the pointer leaves again.
+        if( mBubbleTimer->isActive() ) {
+            mBubbleRemaining = qMax<qint64>( 0, mBubbleDeadline.remainingTime() );
+            mBubbleTimer->stop();
+        }
+    }
+    else {
+        startBubbleDeadline( qMax<qint64>( mBubbleRemaining, BUBBLE_GRACE ) );
+    }
+}
+
+
+void Amor::startBubbleDeadline(qint64 msec)
+{
+    mBubbleDeadline.setRemainingTime( msec );
+    mBubbleTimer->start( int( msec ) );
+}
+
+
 // kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
 // vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
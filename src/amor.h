@@ -19,25 +19,26 @@
 #ifndef AMOR_H
 #define AMOR_H
 
-#include <ctime>
-
 #include <QWidget>
-#include <QQueue>
+#include <QDeadlineTimer>
 #include <QList>
 
 #include <KWindowSystem>
 
-#include "amoranimation.h"
+#include "amorengine.h"
+#include "amorkwindowsystem.h"
+#include "amormessage.h"
+#include "amormessagequeue.h"
 #include "amortips.h"
 #include "amorconfig.h"
 #include "amorthememanager.h"
-#include "queueitem.h"
 
 #include <xcb/xcb.h>
 
 class AmorDialog;
 class AmorBubble;
 class AmorWidget;
+class AmorEventReplayer;
 
 class QTimer;
 class KWindowSystem;
@@ -45,18 +46,35 @@ class QMenu;
 class KConfigBase;
 
 
-class Amor : public QObject
+class Amor : public QObject, public AmorEngine::Host
 {
     Q_OBJECT
 
     public:
-        Amor();
+        explicit Amor(const QString &theme = QString(), Amor *primary = 0);
         ~Amor();
 
         void showTip(const QString &tip);
         void showMessage(const QString &message, int msec = -1);
+        int showMessages(const AmorMessageList &messages);
+
+        QVariantMap state() const;
+        int queueDepth() const;
 
         void reset();
+        void replay(AmorEventReplayer *replayer);
+
+        QVariantMap stats() const;
+        void resetStats();
+        QVariantMap memoryReport() const;
+
+        static void setMemoryReport(bool report);   // print the memory report and quit once all creatures are shown
+
+    signals:
+        void stateChanged(const QString &state);
+        void targetWindowChanged(qulonglong window);
+        void bubbleShown(const QString &text);
+        void bubbleDismissed();
 
     public slots:
         void screenSaverStopped();
@@ -66,13 +84,14 @@ class Amor : public QObject
         void slotStackingChanged();
         void slotWindowChange(WId, NET::Properties, NET::Properties2);
         void slotDesktopChange(int);
+        void slotConfigure();
+        void slotActivateRequested();
 
     protected slots:
         void slotMouseClicked(const QPoint &pos);
         void slotTimeout();
         void slotCursorTimeout();
-        void slotConfigure();
-        void slotConfigChanged();
+        void slotConfigChanged(const AmorConfig &config);
         void slotOffsetChanged(int);
         void slotWidgetDragged( const QPoint &delta, bool release );
         void restack();
@@ -80,40 +99,59 @@ class Amor : public QObject
         void screenSaverStatusChanged(bool active);
 
         void slotBubbleTimeout();
+        void slotBubbleHovered(bool within);
+        void slotLanguageChanged();
 
     protected:
-        enum State { Focus, Blur, Normal, Sleeping, Waking, Destroy };
-
         bool readConfig();
+        void readSettings();
+        void setSettings(const AmorConfig &config);
+        void applySettings();
+        bool loadTheme();
+        bool readTheme(AmorThemeManager *theme);
+        void createWidget();
+        void createCompanions();
+        bool isPrimary() const { return !parent(); }
+        QVariantMap memoryUsage() const;
+        void printMemoryReport();
         void showBubble();
-        void selectAnimation(State state=Normal);
+        bool queueMessage(const QString &message, int msec);
+        void startBubbleDeadline(qint64 msec);
+
+        // AmorEngine::Host
+        bool hasBubble() const override;
+        void dismissBubble() override;
+        void showFrame() override;
+        void targetChanged() override;
+        void targetMoved() override;
+        void hideCreature() override;
+        void enteredState() override;
 
     private:
         KWindowSystem *mWin;
-        xcb_window_t mTargetWin;                 // The window that the animations sits on
-        QRect mTargetRect;              // The goemetry of the target window
-        xcb_window_t mNextTarget;                // The window that will become the target
         AmorWidget *mAmor;              // The widget displaying the animation
         AmorThemeManager mTheme;        // Animations used by current theme
-        AmorAnimation *mBaseAnim;       // The base animation
-        AmorAnimation *mCurrAnim;       // The currently running animation
-        int mPosition;                  // The position of the animation
-        State mState;                   // The current state of the animation
-        QTimer *mTimer;                 // Frame timer
+        AmorThemeManager *mRetiredTheme; // the previous theme, until its last frame is replaced
+        AmorKWindowSystem mWindowSystem;
+        AmorTimerClock mClock;          // Frame timer
+        AmorEngine mEngine;             // Animation state, position and target window
         QTimer *mCursorTimer;           // Cursor timer
         QTimer *mStackTimer;            // Restacking timer
         QTimer *mBubbleTimer;           // Bubble tip timer (GP: I didn't create this one, it had no use when I found it)
+        QDeadlineTimer mBubbleDeadline; // when the bubble expires
+        qint64 mBubbleRemaining;        // time left while the pointer holds the bubble open
         QMenu *mMenu;                   // Our menu
-        std::time_t mActiveTime;        // The time an active event occurred
-        QPoint mCursPos;                // The last recorded position of the pointer
         QString mTipText;               // Text to display in a bubble when possible
-        AmorBubble *mBubble;            // Text bubble
+        AmorBubble *mBubble;            // Text bubble, while one is shown
+        AmorBubble *mBubbleWindow;      // the bubble window, kept for reuse
         AmorTips mTips;                 // Tips to display in the bubble
-        bool mInDesktopBottom;          // the animation is not on top of the
-                                        // title bar, but at the bottom of the desktop
         AmorConfig mConfig;             // Configuration parameters
+        QString mCompanionTheme;        // theme of a companion, empty for the primary creature
+        AmorEventReplayer *mReplayer;   // source of the window events when replaying a log
         bool mForceHideAmorWidget;
-        QQueue<QueueItem> mTipsQueue;   // GP: tips queue
+        AmorMessageQueue mTipsQueue;    // GP: tips queue, now also bounded and prioritized
+
+        static bool mMemoryReport;
 };
 
 
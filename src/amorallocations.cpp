@@ -0,0 +1,83 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amorallocations.h"
+
+#include <stddef.h>
+
+#ifdef AMOR_COUNT_ALLOCATIONS
+
+// glibc exports its allocator under these names, so the wrappers below
+// can replace malloc without a dynamic lookup that would itself allocate.
+extern "C" {
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *pointer, size_t size);
+}
+
+static qint64 sAllocations = 0;
+
+
+extern "C" void *malloc(size_t size)
+{
+    __atomic_add_fetch( &sAllocations, 1, __ATOMIC_RELAXED );
+    return __libc_malloc( size );
+}
+
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    __atomic_add_fetch( &sAllocations, 1, __ATOMIC_RELAXED );
+    return __libc_calloc( count, size );
+}
+
+
+extern "C" void *realloc(void *pointer, size_t size)
+{
+    __atomic_add_fetch( &sAllocations, 1, __ATOMIC_RELAXED );
+    return __libc_realloc( pointer, size );
+}
+
+
+bool AmorAllocations::isEnabled()
+{
+    return true;
+}
+
+
+qint64 AmorAllocations::count()
+{
+    return __atomic_load_n( &sAllocations, __ATOMIC_RELAXED );
+}
+
+#else
+
+bool AmorAllocations::isEnabled()
+{
+    return false;
+}
+
+
+qint64 AmorAllocations::count()
+{
+    return 0;
+}
+
+#endif
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -19,19 +19,55 @@
 #include "amoranimation.h"
 #include "amorpixmapmanager.h"
 
-#include <KRandom>
-
-#include <QPixmap>
+#include <QImage>
 #include <QSettings>
 #include <QStandardPaths>
 
 
-AmorAnimation::AmorAnimation(const QSettings *config)
+// Returns the bounding rectangle of the pixels that differ between two frames.
+static QRect changedRect(const QImage &from, const QImage &to)
+{
+    if( from.isNull() || from.size() != to.size() || from.format() != to.format() ) {
+        return to.rect();
+    }
+
+    int top = to.height();
+    int bottom = -1;
+    int left = to.width();
+    int right = -1;
+
+    for(int y = 0; y < to.height(); ++y) {
+        const QRgb *a = reinterpret_cast<const QRgb *>( from.constScanLine( y ) );
+        const QRgb *b = reinterpret_cast<const QRgb *>( to.constScanLine( y ) );
+        for(int x = 0; x < to.width(); ++x) {
+            if( a[x] != b[x] ) {
+                top = qMin( top, y );
+                bottom = y;
+                left = qMin( left, x );
+                right = qMax( right, x );
+            }
+        }
+    }
+
+    return bottom < 0 ? QRect() : QRect( QPoint( left, top ), QPoint( right, bottom ) );
+}
+
+
+AmorAnimation::AmorAnimation(const QSettings *config, const QString &pixmapDir)
   : mCurrent( 0 ),
     mTotalMovement( 0 ),
-    mMaximumSize(0, 0)
+    mMaximumSize(0, 0),
+    mWeight( 1.0 )
 {
-    readConfig(config);
+    readConfig(config, pixmapDir);
+}
+
+
+AmorAnimation::~AmorAnimation()
+{
+    for(const QImage *frame : qAsConst( mFrames )) {
+        AmorPixmapManager::manager()->release( frame );
+    }
 }
 
 
@@ -89,24 +125,76 @@ int AmorAnimation::movement() const
 }
 
 
-const QPixmap *AmorAnimation::frame()
+qreal AmorAnimation::weight() const
+{
+    return mWeight;
+}
+
+
+const QImage *AmorAnimation::frame() const
+{
+    return validFrame() ? mFrames.at( mCurrent ) : 0;
+}
+
+
+QRect AmorAnimation::damage(const QImage *shown) const
+{
+    const QImage *current = frame();
+    if( !current || current == shown ) {
+        return QRect();
+    }
+
+    // The precomputed damage is only valid if the previous frame of this
+    // animation is what is on screen right now.
+    if( mCurrent > 0 && shown == mFrames.at( mCurrent - 1 ) ) {
+        return mDamage.at( mCurrent );
+    }
+
+    return current->rect();
+}
+
+
+const QVector<const QImage*> &AmorAnimation::frames() const
 {
-    return validFrame() ? AmorPixmapManager::manager()->pixmap( mSequence.at( mCurrent ) ) : 0;
+    return mFrames;
 }
 
 
-void AmorAnimation::readConfig(const QSettings *config)
+void AmorAnimation::readConfig(const QSettings *config, const QString &pixmapDir)
 {
     // Read the list of frames to display and load them into the pixmap manager.
     mSequence = config->value( "Sequence" ).toStringList();
     int frames = mSequence.count();
-    for(QStringList::Iterator it = mSequence.begin(); it != mSequence.end(); ++it) {
-        const QPixmap *pixmap = AmorPixmapManager::manager()->load( *it );
-        if( pixmap ) {
-            mMaximumSize = mMaximumSize.expandedTo( pixmap->size() );
+    mFrames.resize( frames );
+    for(int i = 0; i < frames; ++i) {
+        mFrames[i] = AmorPixmapManager::manager()->load( pixmapDir + QLatin1Char( '/' ) + mSequence.at( i ) );
+        if( mFrames[i] ) {
+            mMaximumSize = mMaximumSize.expandedTo( mFrames[i]->size() );
+        }
+    }
+
+    // Work out which part of each frame differs from the frame before it, so
+    // advancing the animation only repaints that part.
+    mDamage.resize( frames );
+    for(int i = 0; i < frames; ++i) {
+        if( !mFrames[i] ) {
+            mDamage[i] = QRect();
+        }
+        else if( i == 0 || !mFrames[i-1] ) {
+            mDamage[i] = mFrames[i]->rect();
+        }
+        else if( mFrames[i] == mFrames[i-1] ) {
+            mDamage[i] = QRect();
+        }
+        else {
+            mDamage[i] = changedRect( *mFrames[i-1], *mFrames[i] );
         }
     }
 
+    // Read how often the animation is picked compared to the other
+    // animations of its group.
+    mWeight = qMax( 0.0, config->value( "Weight", 1.0 ).toDouble() );
+
     // Read the delays between frames.
     QStringList list;
     list = config->value( "Delay" ).toStringList();
@@ -136,10 +224,16 @@ void AmorAnimation::readConfig(const QSettings *config)
         mHotspot[i].setY( entries.at( i ).toInt() );
     }
 
+    // The pixmap manager trims the transparent border of each frame, so
+    // move the hotspots into the coordinates of the trimmed frames.
+    for(int i = 0; i < frames; ++i) {
+        mHotspot[i] -= AmorPixmapManager::manager()->offset( mFrames[i] );
+    }
+
     // Add the overlap of the last frame to the total movement.
     const QPoint &lastHotspot = mHotspot[ mHotspot.size()-1 ];
     if( mTotalMovement > 0 ) {
-        const QPixmap *lastFrame =  AmorPixmapManager::manager()->pixmap( mSequence.last() );
+        const QImage *lastFrame = mFrames.last();
         if( lastFrame ) {
             mTotalMovement += ( lastFrame->width() - lastHotspot.x() );
         }
@@ -21,17 +21,19 @@
 
 #include <QHash>
 #include <QPoint>
+#include <QRect>
 #include <QSize>
 #include <QStringList>
 #include <QVector>
 
-class QPixmap;
+class QImage;
 class QSettings;
 
 class AmorAnimation
 {
     public:
-        explicit AmorAnimation(const QSettings *config);
+        AmorAnimation(const QSettings *config, const QString &pixmapDir);
+        ~AmorAnimation();
 
         void reset();
         bool next();
@@ -43,20 +45,26 @@ class AmorAnimation
         int delay() const;
         QPoint hotspot() const;
         int movement() const;
+        qreal weight() const;
 
-        const QPixmap *frame();
+        const QImage *frame() const;
+        QRect damage(const QImage *shown) const;
+        const QVector<const QImage*> &frames() const;
 
     protected:
-        void readConfig(const QSettings *config);
+        void readConfig(const QSettings *config, const QString &pixmapDir);
 
     protected:
         int mCurrent;             // current frame in sequence
         QStringList mSequence;    // sequence of images to display
+        QVector<const QImage*> mFrames; // the images, shared through the pixmap manager
         QVector<int> mDelay;      // delay between frames
         QVector<QPoint> mHotspot; // the hotspot in a frame
         QVector<int> mMovement;   // the distance to move between frames
+        QVector<QRect> mDamage;   // the part of a frame that differs from the previous one
         int mTotalMovement;       // the total distance this animation moves
         QSize mMaximumSize;       // the maximum size of any frame
+        qreal mWeight;            // how often the animation is picked from its group
 };
 
 
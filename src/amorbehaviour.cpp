@@ -0,0 +1,175 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amorbehaviour.h"
+#include "amorthememanager.h"
+#include "amor_debug.h"
+
+#include <QSettings>
+
+static const char *const EVENT_NAMES[AmorBehaviour::EventCount] = {
+    "Finished", "Activated", "Lost", "Moved", "Idle", "Activity", "DesktopChanged"
+};
+
+static const char *const FLAG_NAMES[] = { "HideBubble", "Relocate", "Alternate", "Slow" };
+
+// The table is indexed with qint8
+static const int MAX_STATES = 127;
+
+
+AmorBehaviour::AmorBehaviour()
+{
+    addState( QStringLiteral( "Normal" ), AmorThemeManager::NormalGroup, Alternate | Slow );
+    addState( QStringLiteral( "Focus" ), AmorThemeManager::FocusGroup, HideBubble | Relocate );
+    addState( QStringLiteral( "Blur" ), AmorThemeManager::BlurGroup, HideBubble );
+    addState( QStringLiteral( "Destroy" ), AmorThemeManager::DestroyGroup, HideBubble );
+    addState( QStringLiteral( "Sleeping" ), AmorThemeManager::SleepGroup, Slow );
+    addState( QStringLiteral( "Waking" ), AmorThemeManager::WakeGroup, 0 );
+
+    // Events that are handled the same way in every state
+    for(int state = 0; state < BuiltinStateCount; ++state) {
+        setTransition( state, Lost, Destroy );
+        setTransition( state, Moved, Blur );
+        setTransition( state, DesktopChanged, Normal );
+    }
+
+    setTransition( Normal, Finished, Normal );
+    setTransition( Normal, Activated, Focus );
+    setTransition( Normal, Idle, Sleeping );
+
+    setTransition( Focus, Finished, Normal );
+    setTransition( Focus, Activated, Focus );
+    setTransition( Focus, Idle, Sleeping );
+
+    // Blur and Destroy are on their way to Focus already
+    setTransition( Blur, Finished, Focus );
+    setTransition( Destroy, Finished, Focus );
+
+    setTransition( Sleeping, Finished, Sleeping );
+    setTransition( Sleeping, Activated, Focus );
+    setTransition( Sleeping, Activity, Waking );
+
+    setTransition( Waking, Finished, Normal );
+    setTransition( Waking, Activated, Focus );
+    setTransition( Waking, Idle, Sleeping );
+}
+
+
+int AmorBehaviour::addState(const QString &name, int group, int flags)
+{
+    StateInfo info;
+    info.name = name;
+    info.group = group;
+    info.flags = flags;
+    mStates.append( info );
+
+    mTable.resize( mStates.size() * EventCount );
+    const int state = mStates.size() - 1;
+    for(int event = 0; event < EventCount; ++event) {
+        mTable[state * EventCount + event] = -1;
+    }
+
+    return state;
+}
+
+
+void AmorBehaviour::setTransition(int state, Event event, int target)
+{
+    mTable[state * EventCount + event] = target;
+}
+
+
+int AmorBehaviour::stateIndex(const QString &name) const
+{
+    for(int i = 0; i < mStates.size(); ++i) {
+        if( mStates.at( i ).name == name ) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
+bool AmorBehaviour::read(QSettings *config, int firstGroup)
+{
+    config->beginGroup( "Behaviour" );
+
+    // Additional states play the animation group of the same name. Unless
+    // told otherwise they return to Normal and react like the built-in states.
+    const QStringList states = config->value( "States" ).toStringList();
+    for(const QString &name : states) {
+        if( stateIndex( name ) >= 0 ) {
+            continue;
+        }
+        if( mStates.size() >= MAX_STATES ) {
+            qCWarning(AMOR_LOG) << "Too many states in behaviour, ignoring" << name;
+            break;
+        }
+
+        const int state = addState( name, firstGroup + mStates.size() - BuiltinStateCount, 0 );
+        setTransition( state, Finished, Normal );
+        setTransition( state, Activated, Focus );
+        setTransition( state, Lost, Destroy );
+        setTransition( state, Moved, Blur );
+        setTransition( state, DesktopChanged, Normal );
+    }
+
+    bool ok = true;
+    for(int state = 0; state < mStates.size(); ++state) {
+        const QString name = mStates.at( state ).name;
+
+        const QStringList transitions = config->value( name ).toStringList();
+        for(const QString &transition : transitions) {
+            const int separator = transition.indexOf( QLatin1Char( ':' ) );
+            const QString eventName = transition.left( separator ).trimmed();
+            const int target = separator < 0 ? -1 : stateIndex( transition.mid( separator + 1 ).trimmed() );
+
+            int event = 0;
+            while( event < EventCount && eventName != QLatin1String( EVENT_NAMES[event] ) ) {
+                ++event;
+            }
+
+            if( event == EventCount || target < 0 ) {
+                qCWarning(AMOR_LOG) << "Invalid transition" << transition << "of state" << name;
+                ok = false;
+                continue;
+            }
+
+            setTransition( state, static_cast<Event>( event ), target );
+        }
+
+        if( config->contains( name + QLatin1String( "Flags" ) ) ) {
+            int flags = 0;
+            const QStringList names = config->value( name + QLatin1String( "Flags" ) ).toStringList();
+            for(const QString &flag : names) {
+                for(int i = 0; i < int( sizeof( FLAG_NAMES ) / sizeof( FLAG_NAMES[0] ) ); ++i) {
+                    if( flag.trimmed() == QLatin1String( FLAG_NAMES[i] ) ) {
+                        flags |= 1 << i;
+                    }
+                }
+            }
+            mStates[state].flags = flags;
+        }
+    }
+
+    config->endGroup();
+    return ok;
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
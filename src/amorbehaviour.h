@@ -0,0 +1,101 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef AMORBEHAVIOUR_H
+#define AMORBEHAVIOUR_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QSettings;
+
+
+/**
+ * The behaviour of a creature as a table of states and transitions.
+ *
+ * Each state plays an animation group, and each event moves the creature
+ * from one state to another. The built-in states and transitions can be
+ * extended by a theme in its [Behaviour] group:
+ *
+ *   [Behaviour]
+ *   States=Hungry
+ *   Normal=Idle:Hungry
+ *   Hungry=Finished:Normal,Activity:Waking
+ *   HungryFlags=HideBubble
+ *
+ * The animations of a state added this way are listed in the [Config]
+ * group under the name of the state, just like the standard groups.
+ *
+ * All names are resolved when the theme is read, so looking up a
+ * transition is a single index into a dense table.
+ */
+class AmorBehaviour
+{
+    public:
+        enum State { Normal, Focus, Blur, Destroy, Sleeping, Waking, BuiltinStateCount };
+
+        enum Event {
+            Finished,           // the animation of the state ended
+            Activated,          // a window was activated while there was no target
+            Lost,               // the target window was deactivated, closed or minimized
+            Moved,              // the target window moved into or out of the work area
+            Idle,               // the pointer did not move for a while; takes effect when the animation ends
+            Activity,           // the pointer moved, or a tip or message arrived
+            DesktopChanged,     // the current desktop changed
+            EventCount
+        };
+
+        enum Flag {
+            HideBubble = 0x1,   // hide the bubble when entering the state
+            Relocate = 0x2,     // move to the next target window
+            Alternate = 0x4,    // alternate between the base animation and the group
+            Slow = 0x8          // static themes update slowly in this state
+        };
+
+        AmorBehaviour();
+
+        bool read(QSettings *config, int firstGroup);
+
+        int stateCount() const { return mStates.size(); }
+        int transition(int state, Event event) const { return mTable.at( state * EventCount + event ); }
+        int group(int state) const { return mStates.at( state ).group; }
+        int flags(int state) const { return mStates.at( state ).flags; }
+        QString stateName(int state) const { return mStates.at( state ).name; }
+
+    protected:
+        int addState(const QString &name, int group, int flags);
+        void setTransition(int state, Event event, int target);
+        int stateIndex(const QString &name) const;
+
+    protected:
+        struct StateInfo
+        {
+            QString name;
+            int group;          // animation group played in the state
+            int flags;
+        };
+
+        QVector<StateInfo> mStates;
+        QVector<qint8> mTable;   // target state of each state and event, -1 to ignore the event
+};
+
+
+#endif
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -17,12 +17,126 @@
  */
 #include "amorbubble.h"
 
+#include <QPainter>
+#include <QPainterPath>
+#include <QPolygon>
+#include <qdrawutil.h>
+
+
+#define MAX_LAYOUTS     32      // messages whose layout is kept
+#define TEXT_WIDTH      300     // the text is wrapped at this width
+#define MARGIN          6       // between the text and the border
+#define ARROW           12      // width of the balloon's arrow
+#define ARROW_Y         10      // height of the arrow's tip, where the origin is
+
 
 AmorBubble::AmorBubble()
-  : QLabel( 0, Qt::WindowTitleHint | Qt::X11BypassWindowManagerHint ),
-    m_mouseWithin( false )
+  : QWidget( 0, Qt::WindowTitleHint | Qt::X11BypassWindowManagerHint ),
+    m_mouseWithin( false ),
+    m_balloon( false )
+{
+}
+
+
+void AmorBubble::setBalloon(bool balloon)
+{
+    if( balloon != m_balloon ) {
+        m_balloon = balloon;
+        m_layouts.clear();
+    }
+}
+
+
+void AmorBubble::setMessage(const QString &message)
+{
+    const Layout &current = layout( message );
+    m_message = message;
+
+    resize( current.size );
+    if( m_balloon ) {
+        setMask( current.mask );
+    }
+    else {
+        clearMask();
+    }
+
+    update();
+    show();
+}
+
+
+const AmorBubble::Layout &AmorBubble::layout(const QString &message)
 {
-    setFrameStyle(QFrame::Panel | QFrame::Raised);
+    QHash<QString, Layout>::const_iterator it = m_layouts.constFind( message );
+    if( it != m_layouts.constEnd() ) {
+        return *it;
+    }
+
+    if( m_layouts.size() >= MAX_LAYOUTS ) {
+        m_layouts.clear();
+    }
+
+    Layout layout;
+    layout.text.setText( message );
+    layout.text.setTextFormat( Qt::AutoText );
+    layout.text.prepare( QTransform(), font() );
+    if( layout.text.size().width() > TEXT_WIDTH ) {
+        // Only wrap long messages, so that short ones get a small bubble.
+        layout.text.setTextWidth( TEXT_WIDTH );
+        layout.text.prepare( QTransform(), font() );
+    }
+
+    const QSize text = layout.text.size().toSize();
+    const int left = m_balloon ? ARROW : 0;
+    layout.size = QSize( left + text.width() + 2 * MARGIN, qMax( text.height() + 2 * MARGIN, 2 * ARROW_Y ) );
+
+    if( m_balloon ) {
+        QPolygon arrow;
+        arrow << QPoint( 0, ARROW_Y ) << QPoint( ARROW + 1, ARROW_Y - ARROW / 2 ) << QPoint( ARROW + 1, ARROW_Y + ARROW / 2 );
+        layout.mask = QRegion( QRect( ARROW, 0, layout.size.width() - ARROW, layout.size.height() ) ) + QRegion( arrow );
+    }
+
+    return *m_layouts.insert( message, layout );
+}
+
+
+void AmorBubble::hideEvent(QHideEvent *event)
+{
+    // The window is shown again for the next message, and a hidden window
+    // is not guaranteed to get the leave event.
+    m_mouseWithin = false;
+
+    QWidget::hideEvent( event );
+}
+
+
+void AmorBubble::paintEvent(QPaintEvent *)
+{
+    const Layout &current = layout( m_message );
+    QPainter p( this );
+
+    if( m_balloon ) {
+        p.setRenderHint( QPainter::Antialiasing );
+        p.setPen( palette().color( QPalette::ToolTipText ) );
+        p.setBrush( palette().color( QPalette::ToolTipBase ) );
+
+        QPainterPath path;
+        path.addRoundedRect( QRectF( ARROW + 0.5, 0.5, width() - ARROW - 1, height() - 1 ), MARGIN, MARGIN );
+        QPainterPath arrow;
+        arrow.moveTo( 0.5, ARROW_Y );
+        arrow.lineTo( ARROW + 2, ARROW_Y - ARROW / 2 );
+        arrow.lineTo( ARROW + 2, ARROW_Y + ARROW / 2 );
+        arrow.closeSubpath();
+        p.drawPath( path.united( arrow ) );
+        p.drawStaticText( ARROW + MARGIN, MARGIN, current.text );
+    }
+    else {
+        // The raised panel of the label the bubble used to be
+        p.fillRect( rect(), palette().color( QPalette::Window ) );
+        qDrawShadePanel( &p, rect(), palette(), false, 1 );
+        p.setPen( palette().color( QPalette::WindowText ) );
+        p.drawStaticText( MARGIN, MARGIN, current.text );
+    }
 }
 
 
@@ -18,13 +18,22 @@
 #ifndef AMORBUBBLE_H
 #define AMORBUBBLE_H
 
-#include <QLabel>
+#include <QHash>
 #include <QPoint>
+#include <QRegion>
+#include <QStaticText>
+#include <QWidget>
 
-class QLabel;
 
-
-class AmorBubble : public QLabel
+/**
+ * The bubble showing tips and messages next to the creature.
+ *
+ * One bubble window is kept for the lifetime of a creature and is hidden
+ * and shown again for every message. The laid out text of the recent
+ * messages is cached, so showing a message again or the next one of a
+ * queue does not lay out the text from scratch.
+ */
+class AmorBubble : public QWidget
 {
     Q_OBJECT
 
@@ -32,24 +41,36 @@ class AmorBubble : public QLabel
         AmorBubble();
 
         void setOrigin(int x, int y) { move( x + 10, y - 10 ); }
-        void setMessage(const QString &message) { setText( message ); show(); }
+        void setMessage(const QString &message);
+        void setBalloon(bool balloon);  // draw a speech balloon pointing at the origin instead of a panel
 
         bool mouseWithin() { return m_mouseWithin; }
 
+    signals:
+        void hovered(bool within);      // the mouse pointer entered or left the bubble
+        void clicked();                 // the user dismissed the bubble
+
     protected:
-        void enterEvent(QEvent *event) { Q_UNUSED( event ); m_mouseWithin = true; }
-        void leaveEvent(QEvent *event) { Q_UNUSED( event ); m_mouseWithin = false; }        
-        void mouseReleaseEvent(QMouseEvent *event) { Q_UNUSED( event ); hide(); }
+        void paintEvent(QPaintEvent *event);
+        void enterEvent(QEvent *event) { Q_UNUSED( event ); m_mouseWithin = true; emit hovered( true ); }
+        void leaveEvent(QEvent *event) { Q_UNUSED( event ); m_mouseWithin = false; emit hovered( false ); }
+        void mouseReleaseEvent(QMouseEvent *event) { Q_UNUSED( event ); hide(); emit clicked(); }
+        void hideEvent(QHideEvent *event);
 
-    protected:        
-        QLabel *m_label;        // displays the message
-        //QPoint m_position;
+        struct Layout
+        {
+            QStaticText text;   // laid out and prepared for the bubble font
+            QSize size;         // of the whole bubble
+            QRegion mask;       // shape of the balloon, empty for a panel
+        };
+
+        const Layout &layout(const QString &message);
+
+    protected:
+        QHash<QString, Layout> m_layouts;   // recently shown messages
+        QString m_message;
         bool m_mouseWithin;      // the mouse pointer is inside the bubble
-        
-        //QRect mBound;           // bounds of the text
-        //QBitmap mMask;          // shape mask
-        //VertPos mArrowVert;     // vertical position of the arrow
-        //HorzPos mArrowHorz;     // horizontal position of the arrow
+        bool m_balloon;
 };
 
 
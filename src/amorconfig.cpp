@@ -16,6 +16,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 #include "amorconfig.h"
+#include "amorconfigwriter.h"
 
 #include <KConfigGroup>
 #include <KSharedConfig>
@@ -28,13 +29,22 @@ AmorConfig::AmorConfig()
     mTips( false ),
     mRandomTheme( false ),
     mAppTips( true ),
-    mStaticPos( 20 )
+    mStaticPos( 20 ),
+    mOverlay( false ),
+    mQueueLength( 20 ),
+    mQueueOverflow( QLatin1String( "DropOldest" ) ),
+    mBalloon( false )
 {
 }
 
 
 void AmorConfig::read()
 {
+    // The file may not have the values this process saved last yet.
+    if( AmorConfigWriter::writer()->written( this ) ) {
+        return;
+    }
+
     KSharedConfig::Ptr config = KSharedConfig::openConfig();
     KConfigGroup cs( config, "General" );
 
@@ -45,14 +55,23 @@ void AmorConfig::read()
     mRandomTheme = cs.readEntry( "RandomTheme", false );
     mAppTips = cs.readEntry( "ApplicationTips", true );
     mStaticPos = cs.readEntry( "StaticPosition", 20 );
+    mOverlay = cs.readEntry( "Overlay", false );
+    mCompanions = cs.readEntry( "Companions", QStringList() );
+    mFrameStore = cs.readPathEntry( "FrameStore", QString() );
+    mQueueLength = cs.readEntry( "MessageQueueLength", 20 );
+    mQueueOverflow = cs.readEntry( "MessageQueueOverflow", "DropOldest" );
+    mBalloon = cs.readEntry( "BalloonBubble", false );
 }
 
 
 void AmorConfig::write()
 {
-    KSharedConfig::Ptr config = KSharedConfig::openConfig();
-    KConfigGroup cs( config, "General" );
+    AmorConfigWriter::writer()->write( *this );
+}
 
+
+void AmorConfig::write(KConfigGroup &cs) const
+{
     cs.writeEntry( "OnTop", mOnTop );
     cs.writeEntry( "Offset", mOffset );
     cs.writeEntry( "Theme", mTheme );
@@ -60,8 +79,8 @@ void AmorConfig::write()
     cs.writeEntry( "RandomTheme", mRandomTheme );
     cs.writeEntry( "ApplicationTips", mAppTips );
     cs.writeEntry( "StaticPosition", mStaticPos );
-
-    config->sync();
+    cs.writeEntry( "Overlay", mOverlay );
+    cs.writeEntry( "Companions", mCompanions );
 }
 
 
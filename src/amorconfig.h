@@ -19,6 +19,9 @@
 #define AMORCONFIG_H
 
 #include <QString>
+#include <QStringList>
+
+class KConfigGroup;
 
 
 struct AmorConfig
@@ -26,7 +29,8 @@ struct AmorConfig
     AmorConfig();
 
     void read();
-    void write();
+    void write();                           // saved in the background by AmorConfigWriter
+    void write(KConfigGroup &group) const;  // the settings of the dialog
 
     QString mTheme;
     bool mOnTop;
@@ -35,6 +39,12 @@ struct AmorConfig
     bool mRandomTheme;
     bool mAppTips;
     int mStaticPos;
+    bool mOverlay;
+    QStringList mCompanions;    // themes of additional creatures
+    QString mFrameStore;        // shared frames built by amor-themec
+    int mQueueLength;           // messages and tips waiting for the bubble at most
+    QString mQueueOverflow;     // what to do with more: DropOldest, Summarize or Reject
+    bool mBalloon;              // draw the bubble as a speech balloon
 };
 
 
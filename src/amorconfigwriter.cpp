@@ -0,0 +1,145 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amorconfigwriter.h"
+
+#include <QCoreApplication>
+#include <QRunnable>
+
+#include <KConfig>
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#define WRITE_INTERVAL 1000     // ms between writes at least
+
+AmorConfigWriter *AmorConfigWriter::mWriter = 0;
+
+
+// Saves one snapshot of the configuration in the writer's thread
+class AmorConfigWriteJob : public QRunnable
+{
+    public:
+        AmorConfigWriteJob(AmorConfigWriter *writer, const QString &fileName, const AmorConfig &config, int generation)
+          : mWriter( writer ),
+            mFileName( fileName ),
+            mConfig( config ),
+            mGeneration( generation )
+        {
+        }
+
+        void run() override
+        {
+            {
+                KConfig file( mFileName, KConfig::SimpleConfig );
+                KConfigGroup group( &file, "General" );
+                mConfig.write( group );
+                file.sync();
+            }
+
+            AmorConfigWriter *writer = mWriter;
+            const int generation = mGeneration;
+            QMetaObject::invokeMethod( writer, [writer, generation]() { writer->slotWritten( generation ); }, Qt::QueuedConnection );
+        }
+
+    private:
+        AmorConfigWriter *mWriter;
+        QString mFileName;
+        AmorConfig mConfig;
+        int mGeneration;        // of the values written
+};
+
+
+AmorConfigWriter::AmorConfigWriter()
+  : mFileName( KSharedConfig::openConfig()->name() ),
+    mWritten( false ),
+    mGeneration( 0 )
+{
+    mPool.setMaxThreadCount( 1 );   // keeps the writes in order
+
+    mTimer.setSingleShot( true );
+    mTimer.setInterval( WRITE_INTERVAL );
+    connect( &mTimer, SIGNAL(timeout()), SLOT(slotTimeout()) );
+
+    if( QCoreApplication::instance() ) {
+        connect( QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &AmorConfigWriter::flush );
+    }
+}
+
+
+AmorConfigWriter *AmorConfigWriter::writer()
+{
+    if( !mWriter ) {
+        mWriter = new AmorConfigWriter;
+    }
+
+    return mWriter;
+}
+
+
+void AmorConfigWriter::write(const AmorConfig &config)
+{
+    mPending = config;
+    mWritten = true;
+    ++mGeneration;
+    if( !mTimer.isActive() ) {
+        mTimer.start();
+    }
+}
+
+
+bool AmorConfigWriter::written(AmorConfig *config) const
+{
+    if( mWritten ) {
+        *config = mPending;
+    }
+
+    return mWritten;
+}
+
+
+void AmorConfigWriter::flush()
+{
+    if( mTimer.isActive() ) {
+        mTimer.stop();
+        slotTimeout();
+    }
+
+    mPool.waitForDone();
+}
+
+
+void AmorConfigWriter::slotTimeout()
+{
+    mPool.start( new AmorConfigWriteJob( this, mFileName, mPending, mGeneration ) );
+}
+
+
+void AmorConfigWriter::slotWritten(int generation)
+{
+    // The job wrote through a KConfig of its own, so the shared one still
+    // holds the old contents.
+    KSharedConfig::openConfig()->reparseConfiguration();
+
+    // Read the file again from now on, to see changes made by others too,
+    // unless newer values are still waiting to be written.
+    if( generation == mGeneration && !mTimer.isActive() ) {
+        mWritten = false;
+    }
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
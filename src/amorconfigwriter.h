@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef AMORCONFIGWRITER_H
+#define AMORCONFIGWRITER_H
+
+#include "amorconfig.h"
+
+#include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+
+
+/**
+ * Writes the configuration to disk off the GUI thread.
+ *
+ * Writes are debounced: the configuration is saved once a second at most,
+ * with the values of the last write() call, so dragging a creature or
+ * trying settings in the dialog never waits for a (possibly remote) home
+ * directory. The writes are done one after the other on a thread of their
+ * own, and pending ones are flushed when the application quits. Until
+ * the last values are in the file, AmorConfig::read() takes them from
+ * written() instead, without waiting for the writes.
+ */
+class AmorConfigWriter : public QObject
+{
+    Q_OBJECT
+
+    friend class AmorConfigWriteJob;
+
+    public:
+        static AmorConfigWriter *writer();
+
+        void write(const AmorConfig &config);
+        bool written(AmorConfig *config) const;     // the values of the last write(), if not in the file yet
+        void flush();       // start a pending write and wait for all writes to finish
+
+    protected:
+        AmorConfigWriter();
+
+    protected slots:
+        void slotTimeout();
+        void slotWritten(int generation);
+
+    private:
+        QTimer mTimer;
+        QThreadPool mPool;
+        AmorConfig mPending;        // the values to write next, or written last
+        bool mWritten;              // the file does not have mPending yet
+        int mGeneration;            // counts the write() calls
+        QString mFileName;
+
+        static AmorConfigWriter *mWriter;
+};
+
+
+#endif
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -16,6 +16,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 #include "amordialog.h"
+#include "amorthemeindex.h"
+#include "amorpreview.h"
 
 #include <QCheckBox>
 #include <QLabel>
@@ -25,15 +27,10 @@
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QTextBrowser>
-#include <QStandardPaths>
 #include <QGridLayout>
-#include <QDir>
 #include <QDialogButtonBox>
 #include <QPushButton>
 
-#include <KConfig>
-#include <KConfigGroup>
-#include <KSharedConfig>
 #include <KLocalizedString>
 
 AmorDialog::AmorDialog(QWidget *parent)
@@ -74,10 +71,15 @@ AmorDialog::AmorDialog(QWidget *parent)
     mThemeListView->setMinimumSize( fontMetrics().maxWidth()*20, fontMetrics().lineSpacing()*6 );
     gridLayout->addWidget( mThemeListView, 1, 0 );
 
+    QHBoxLayout *aboutLayout = new QHBoxLayout();
     mAboutEdit = new QTextBrowser( this );
     mAboutEdit->setReadOnly( true );
     mAboutEdit->setMinimumHeight( fontMetrics().lineSpacing()*4 );
-    gridLayout->addWidget( mAboutEdit, 2, 0 );
+    aboutLayout->addWidget( mAboutEdit );
+
+    mPreview = new AmorPreview( this );
+    aboutLayout->addWidget( mPreview );
+    gridLayout->addLayout( aboutLayout, 2, 0 );
 
     // Animation offset
     label = new QLabel( i18n("Offset:"), this );
@@ -111,62 +113,70 @@ AmorDialog::AmorDialog(QWidget *parent)
     checkBox->setChecked( mConfig.mAppTips );
     gridLayout->addWidget( checkBox, 6, 0, 1, 2 );
 
+    checkBox = new QCheckBox( i18n( "Draw in a shared overlay" ), this );
+    checkBox->setToolTip( i18n( "Draw the character into one transparent window per screen. "
+                                "Needs a compositor, and the character no longer reacts to the mouse." ) );
+    connect( checkBox, SIGNAL(toggled(bool)), SLOT(slotOverlay(bool)) );
+    checkBox->setChecked( mConfig.mOverlay );
+    gridLayout->addWidget( checkBox, 7, 0, 1, 2 );
+
     readThemes();
+    connect( AmorThemeIndex::index(), SIGNAL(changed()), SLOT(readThemes()) );
+    connect( AmorThemeIndex::index(), SIGNAL(imagesLoaded(QString)), SLOT(slotImagesLoaded(QString)) );
 }
 
 
 void AmorDialog::readThemes()
 {
-    // Non-recursive search for theme files, with the relative paths stored
-    // in files so that absolute paths are not used.
-    const auto folders = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, QStringLiteral("amor"),
-                                        QStandardPaths::LocateDirectory);
-
-    for (const auto &folder : folders) {
-        QDir amorDir(folder);
-        const auto files = amorDir.entryList({ QStringLiteral("*rc") }, QDir::Files, QDir::NoSort);
-
-        for (const auto &file : files) {
-            addTheme(folder, file);
-        }
+    // The themes come from the index, which keeps their descriptions and
+    // icons. Icons that are not known yet are read in the background and
+    // filled in by slotImagesLoaded().
+    const QString current = mConfig.mTheme;
+    mThemeListView->clear();
+    mThemes.clear();
+    mThemeAbout.clear();
+
+    const QVector<AmorThemeInfo> &themes = AmorThemeIndex::index()->themes();
+    for (const AmorThemeInfo &theme : themes) {
+        addTheme(theme);
     }
+
+    mConfig.mTheme = current;
+    AmorThemeIndex::index()->loadImages();
 }
 
 
-void AmorDialog::addTheme(const QString& folder, const QString& file)
+void AmorDialog::addTheme(const AmorThemeInfo &theme)
 {
-    KConfig config(QStandardPaths::locate(QStandardPaths::GenericDataLocation,
-                                          QStringLiteral("amor/%1").arg(file)));
-    KConfigGroup configGroup( &config, "Config" );
-
-    QString pixmapPath = folder
-                       + QDir::separator()
-                       + configGroup.readPathEntry( "PixmapPath", QString() );
-    if( pixmapPath.isEmpty() ) {
-        return;
-    }
+    QListWidgetItem *item = new QListWidgetItem( theme.description, mThemeListView );
+    setImages( item, theme );
+    mThemes.append( theme.file );
+    mThemeAbout.append( theme.about );
 
-    pixmapPath += QDir::separator();
-    if( pixmapPath[0] != QDir::separator() ) {
-        // relative to config file. We add a / to indicate the dir
-        pixmapPath = QStandardPaths::locate(QStandardPaths::GenericDataLocation,
-                                            QStringLiteral("amor/%1").arg(pixmapPath),
-                                            QStandardPaths::LocateDirectory);
+    if( mConfig.mTheme == theme.file ) {
+        mThemeListView->setCurrentItem( item );
     }
+}
 
-    QString description = configGroup.readEntry( "Description" );
-    QString about = configGroup.readEntry( "About", " " );
-    QString pixmapName = configGroup.readEntry( "Icon" );
 
-    pixmapPath += pixmapName;
-    QPixmap pixmap( pixmapPath );
+void AmorDialog::setImages(QListWidgetItem *item, const AmorThemeInfo &theme)
+{
+    if( !theme.maximumSize.isValid() ) {
+        return;     // still being read
+    }
+
+    item->setIcon( QIcon( QPixmap::fromImage( theme.icon ) ) );
+    item->setToolTip( i18np( "%1 frame, up to %2×%3 pixels", "%1 frames, up to %2×%3 pixels", theme.frames,
+                             theme.maximumSize.width(), theme.maximumSize.height() ) );
+}
 
-    QListWidgetItem *item = new QListWidgetItem( QIcon(pixmap), description, mThemeListView );
-    mThemes.append( file );
-    mThemeAbout.append( about );
 
-    if( mConfig.mTheme == file ) {
-        mThemeListView->setCurrentItem( item );
+void AmorDialog::slotImagesLoaded(const QString &file)
+{
+    const int row = mThemes.indexOf( file );
+    const AmorThemeInfo *theme = AmorThemeIndex::index()->theme( file );
+    if( row >= 0 && theme ) {
+        setImages( mThemeListView->item( row ), *theme );
     }
 }
 
@@ -179,6 +189,10 @@ void AmorDialog::slotHighlighted(int index)
 
     mConfig.mTheme = mThemes.at( index );
     mAboutEdit->setPlainText( mThemeAbout.at( index ) );
+    const AmorThemeInfo *theme = AmorThemeIndex::index()->theme( mConfig.mTheme );
+    if( theme ) {
+        mPreview->setTheme( theme->path, theme->icon );
+    }
 }
 
 
@@ -214,10 +228,16 @@ void AmorDialog::slotApplicationTips(bool tips)
 }
 
 
+void AmorDialog::slotOverlay(bool overlay)
+{
+    mConfig.mOverlay = overlay;
+}
+
+
 void AmorDialog::slotOk()
 {
     mConfig.write();
-    emit changed();
+    emit changed( mConfig );
     accept();
 }
 
@@ -225,16 +245,16 @@ void AmorDialog::slotOk()
 void AmorDialog::slotApply()
 {
     mConfig.write();
-    emit changed();
+    emit changed( mConfig );
 }
 
 
 void AmorDialog::slotCancel()
 {
-    // restore offset
-    KSharedConfig::Ptr config = KSharedConfig::openConfig();
-    KConfigGroup cs( config, "General" );
-    emit offsetChanged( cs.readEntry( "Offset", 0 ) );
+    // restore offset, as last saved
+    AmorConfig saved;
+    saved.read();
+    emit offsetChanged( saved.mOffset );
     reject();
 }
 
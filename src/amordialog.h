@@ -21,7 +21,11 @@
 #include <QDialog>
 #include "amorconfig.h"
 
+struct AmorThemeInfo;
+class AmorPreview;
+
 class QListWidget;
+class QListWidgetItem;
 class QTextBrowser;
 
 
@@ -33,7 +37,7 @@ class AmorDialog : public QDialog
         explicit AmorDialog(QWidget *parent = 0);
 
     signals:
-        void changed();
+        void changed(const AmorConfig &config);
         void offsetChanged(int);
 
     protected slots:
@@ -42,18 +46,22 @@ class AmorDialog : public QDialog
         void slotRandomTips(bool);
         void slotRandomTheme(bool);
         void slotApplicationTips(bool);
+        void slotOverlay(bool);
         void slotOffset(int);
         void slotOk();
         void slotApply();
         void slotCancel();
+        void readThemes();
+        void slotImagesLoaded(const QString &file);
 
     protected:
-        void readThemes();
-        void addTheme(const QString& folder, const QString& file);
+        void addTheme(const AmorThemeInfo &theme);
+        void setImages(QListWidgetItem *item, const AmorThemeInfo &theme);
 
     protected:
         QListWidget *mThemeListView;
         QTextBrowser *mAboutEdit;
+        AmorPreview *mPreview;      // animates the highlighted theme
         QStringList mThemes;
         QStringList mThemeAbout;
         AmorConfig mConfig;
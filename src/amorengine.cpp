@@ -0,0 +1,480 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amorengine.h"
+#include "amoranimation.h"
+#include "amorthememanager.h"
+#include "amortrace.h"
+#include "amorwindowsystem.h"
+
+#define SLEEP_TIMEOUT   180000  // Animation sleeps after SLEEP_TIMEOUT ms
+                                // of mouse inactivity.
+
+
+AmorEngine::AmorEngine(AmorWindowSystem *windowSystem, AmorClock *clock, Host *host)
+  : mWindowSystem( windowSystem ),
+    mClock( clock ),
+    mHost( host ),
+    mTheme( 0 ),
+    mRandom( QRandomGenerator::global()->generate() ),
+    mTargetWin( 0 ),
+    mNextTarget( 0 ),
+    mBaseAnim( 0 ),
+    mCurrAnim( 0 ),
+    mPosition( -1 ),
+    mState( AmorBehaviour::Normal ),
+    mPendingState( -1 ),
+    mInDesktopBottom( false ),
+    mOffset( 0 ),
+    mStaticPos( 0 ),
+    mActiveTime( 0 )
+{
+}
+
+
+void AmorEngine::setTheme(const AmorThemeManager *theme)
+{
+    mTheme = theme;
+}
+
+
+void AmorEngine::setOffset(int offset)
+{
+    mOffset = offset;
+}
+
+
+void AmorEngine::setStaticPosition(int position)
+{
+    mStaticPos = position;
+}
+
+
+void AmorEngine::setWindowSystem(AmorWindowSystem *windowSystem)
+{
+    mWindowSystem = windowSystem;
+}
+
+
+void AmorEngine::setSeed(quint32 seed)
+{
+    mRandom.seed( seed );
+}
+
+
+void AmorEngine::start()
+{
+    mBaseAnim = mTheme->random( AmorThemeManager::BaseGroup, &mRandom );
+    mCurrAnim = mBaseAnim;
+    mPosition = -1;
+    mState = AmorBehaviour::Normal;
+    mPendingState = -1;
+
+    mActiveTime = mClock->elapsed();
+    mCursPos = mWindowSystem->cursorPos();
+
+    mNextTarget = mWindowSystem->activeWindow();
+    selectAnimation( AmorBehaviour::Focus );
+    mClock->start( 0 );
+}
+
+
+void AmorEngine::restart()
+{
+    // The theme was read again, so the old animations are gone.
+    mBaseAnim = mTheme->random( AmorThemeManager::BaseGroup, &mRandom );
+    mCurrAnim = mBaseAnim;
+    mPosition = mCurrAnim->hotspot().x();
+    mState = AmorBehaviour::Normal;
+    mPendingState = -1;
+
+    mCurrAnim->reset();
+    mClock->start( 0 );
+}
+
+
+QPoint AmorEngine::framePosition() const
+{
+    return QPoint( mTargetRect.x() + mPosition - mCurrAnim->hotspot().x(),
+                   mTargetRect.y() - mCurrAnim->hotspot().y() + ( !mInDesktopBottom ? mOffset : 0 ) );
+}
+
+
+int AmorEngine::staticPosition() const
+{
+    // Positions in the right half are stored relative to the right edge.
+    int savePos = mPosition;
+    if( savePos > mTargetRect.width()/2 ) {
+        savePos -= (mTargetRect.width()+1);
+    }
+
+    return savePos;
+}
+
+
+int AmorEngine::delay() const
+{
+    if( mTheme->isStatic() ) {
+        return mTheme->behaviour().flags( mState ) & AmorBehaviour::Slow ? 1000 : 100;
+    }
+
+    return mCurrAnim->delay();
+}
+
+
+void AmorEngine::tick()
+{
+    if( !mTheme->isStatic() ) {
+        mPosition += mCurrAnim->movement();
+    }
+
+    if( mHost ) {
+        mHost->showFrame();
+    }
+
+    mClock->start( delay() );
+
+    if( !mCurrAnim->next() ) {
+        if( mHost && mHost->hasBubble() ) {
+            mCurrAnim->reset();
+        }
+        else if( mPendingState >= 0 ) {
+            selectAnimation( mPendingState );
+        }
+        else {
+            handleEvent( AmorBehaviour::Finished );
+        }
+    }
+}
+
+
+bool AmorEngine::activity()
+{
+    return handleEvent( AmorBehaviour::Activity );
+}
+
+
+void AmorEngine::markActive()
+{
+    mActiveTime = mClock->elapsed();
+}
+
+
+void AmorEngine::pollActivity(bool mayIdle)
+{
+    const QPoint currPos = mWindowSystem->cursorPos();
+    const QPoint diff = currPos - mCursPos;
+    const qint64 now = mClock->elapsed();
+
+    if( qAbs( diff.x() ) > 1 || qAbs( diff.y() ) > 1 ) {
+        handleEvent( AmorBehaviour::Activity );
+        mActiveTime = now;
+        mCursPos = currPos;
+    }
+    else if( now - mActiveTime > SLEEP_TIMEOUT && mayIdle ) {
+        handleEvent( AmorBehaviour::Idle );
+    }
+}
+
+
+void AmorEngine::dragBy(int dx)
+{
+    if( !mCurrAnim->frame() ) {
+        return;
+    }
+
+    int newPosition = mPosition + dx;
+
+    if( mCurrAnim->totalMovement() + newPosition > mTargetRect.width() ) {
+        newPosition = mTargetRect.width() - mCurrAnim->totalMovement();
+    }
+    else if( mCurrAnim->totalMovement() + newPosition < 0 ) {
+        newPosition = -mCurrAnim->totalMovement();
+    }
+
+    mPosition = newPosition;
+}
+
+
+bool AmorEngine::handleEvent(AmorBehaviour::Event event)
+{
+    if( event == AmorBehaviour::Activity ) {
+        mPendingState = -1;     // the user is back before the creature fell asleep
+    }
+
+    const int state = mTheme->behaviour().transition( mState, event );
+    if( state < 0 ) {
+        return false;
+    }
+
+    if( event == AmorBehaviour::Idle ) {
+        mPendingState = state;  // The next animation will use this state
+        return false;
+    }
+
+    selectAnimation( state );
+    return true;
+}
+
+
+void AmorEngine::placeStatic()
+{
+    if( mStaticPos < 0 ) {
+        mPosition = mTargetRect.width() + mStaticPos;
+    }
+    else {
+        mPosition = mStaticPos;
+    }
+
+    if( mPosition >= mTargetRect.width() ) {
+        mPosition = mTargetRect.width()-1;
+    }
+    else if( mPosition < 0 ) {
+        mPosition = 0;
+    }
+}
+
+
+void AmorEngine::selectAnimation(int state)
+{
+    AMOR_TRACE_SCOPE( "AmorEngine::selectAnimation" );
+
+    const AmorBehaviour &behaviour = mTheme->behaviour();
+    const int flags = behaviour.flags( state );
+    bool changedLocation = true;
+    AmorAnimation *oldAnim = mCurrAnim;
+    const int oldState = mState;
+
+    mState = state;
+    mPendingState = -1;
+
+    if( ( flags & AmorBehaviour::HideBubble ) && mHost ) {
+        mHost->dismissBubble();
+    }
+
+    if( flags & AmorBehaviour::Alternate ) {
+        // Select a random animation if the current animation
+        // is not the base, otherwise select the base.  This makes us
+        // alternate between the base animation and a random animination.
+        if( !( mHost && mHost->hasBubble() ) && mCurrAnim == mBaseAnim ) {
+            mCurrAnim = mTheme->random( behaviour.group( state ), &mRandom );
+        }
+        else {
+            mCurrAnim = mBaseAnim;
+        }
+    }
+    else {
+        mCurrAnim = mTheme->random( behaviour.group( state ), &mRandom );
+    }
+
+    if( !mCurrAnim ) {
+        mCurrAnim = mBaseAnim;
+    }
+
+    if( flags & AmorBehaviour::Relocate ) {
+        if( oldAnim != mCurrAnim ) {
+            mCurrAnim->reset();
+        }
+
+        mTargetWin = mNextTarget;
+
+        if( mTargetWin ) {
+            mTargetRect = mWindowSystem->frameGeometry( mTargetWin );
+
+            // if the animation falls outside of the working area,
+            // then relocate it so that is inside the desktop again
+            const QRect desktopArea = mWindowSystem->workArea();
+
+            bool fitsInWorkArea = mTargetRect.y() - mCurrAnim->hotspot().y() + mOffset < desktopArea.y();
+            if( mWindowSystem->isMaximizedVertically( mTargetWin ) || fitsInWorkArea ) {
+                if( mInDesktopBottom ) {
+                    changedLocation = false;
+                }
+
+                // relocate the animation at the bottom of the screen
+                mTargetRect = QRect( desktopArea.x(), desktopArea.y() + desktopArea.height(), desktopArea.width(), 0 );
+
+                // we'll relocate the animation in the desktop
+                // frame, so do not add the offset to its vertical position
+                mInDesktopBottom = true;
+            }
+            else {
+                mInDesktopBottom = false;
+            }
+
+            if( mTheme->isStatic() ) {
+                placeStatic();
+            }
+            else {
+                if( mCurrAnim->frame() ) {
+                    if( mTargetRect.width() == mCurrAnim->frame()->width() ) {
+                        mPosition = mCurrAnim->hotspot().x();
+                    }
+                    else if(changedLocation || mPosition < 0) {
+                        const int range = mTargetRect.width() - mCurrAnim->frame()->width();
+                        mPosition = range > 0 ? mRandom.bounded( range ) : 0;
+                        mPosition += mCurrAnim->hotspot().x();
+                    }
+                }
+                else {
+                    mPosition = mTargetRect.width()/2;
+                }
+            }
+        }
+        else {
+            // We don't want to do anything until a window comes into focus.
+            mClock->stop();
+        }
+
+        if( mHost ) {
+            mHost->targetChanged();
+        }
+    }
+
+    if( mCurrAnim->totalMovement() + mPosition > mTargetRect.width() || mCurrAnim->totalMovement() + mPosition < 0 ) {
+        // The selected animation would end outside of this window's width
+        // We could randomly select a different one, but I prefer to just
+        // use the default animation.
+        mCurrAnim = mBaseAnim;
+    }
+
+    if( changedLocation ) {
+        mCurrAnim->reset();
+    }
+    else {
+        mCurrAnim = oldAnim;
+    }
+
+    if( mState != oldState && mHost ) {
+        mHost->enteredState();
+    }
+}
+
+
+void AmorEngine::windowActivated(WId win)
+{
+    mClock->stop();
+    mNextTarget = win;
+
+    // This is an active event that affects the target window
+    markActive();
+
+    // A window gaining focus implies that the current window has lost
+    // focus.  Initiate a blur event if there is a current active window.
+    if( mTargetWin ) {
+        // We are losing focus from the current window
+        mClock->start( 0 );
+        handleEvent( AmorBehaviour::Lost );
+    }
+    else if( mNextTarget ) {
+        // We are setting focus to a new window
+        handleEvent( AmorBehaviour::Activated );
+        mClock->start( 0 );
+    }
+    else if( mHost ) {
+        // No action - We can get this when we switch between two empty desktops
+        mHost->hideCreature();
+    }
+}
+
+
+void AmorEngine::windowRemoved(WId win)
+{
+    if( win == mTargetWin ) {
+        // This is an active event that affects the target window
+        markActive();
+
+        handleEvent( AmorBehaviour::Lost );
+        mClock->stop();
+        mClock->start( 0 );
+    }
+}
+
+
+void AmorEngine::windowChanged(WId win, bool geometryChanged)
+{
+    if( win != mTargetWin ) {
+        return;
+    }
+
+    // This is an active event that affects the target window
+    markActive();
+
+    if( mWindowSystem->isMinimized( mTargetWin ) ) {
+        // The target window has been iconified
+        handleEvent( AmorBehaviour::Lost );
+        mTargetWin = 0;
+        mClock->stop();
+        mClock->start( 0 );
+
+        return;
+    }
+
+    if( geometryChanged ) {
+        QRect newTargetRect = mWindowSystem->frameGeometry( mTargetWin );
+
+        // if the change in the window caused the animation to fall
+        // out of the working area of the desktop, or if the animation
+        // didn't fall in the working area before but it does now, then
+        //  refocus on the current window so that the animation is
+        // relocated.
+        QRect desktopArea = mWindowSystem->workArea();
+
+        bool fitsInWorkArea = !( newTargetRect.y() - mCurrAnim->hotspot().y() + mOffset < desktopArea.y() );
+        if( ( !fitsInWorkArea && !mInDesktopBottom ) || ( fitsInWorkArea && mInDesktopBottom ) ) {
+            mNextTarget = mTargetWin;
+            handleEvent( AmorBehaviour::Moved );
+            mClock->start( 0 );
+
+            return;
+        }
+
+        if( !mInDesktopBottom ) {
+            mTargetRect = newTargetRect;
+        }
+
+        // make sure the animation is still on the window.
+        if( mCurrAnim->frame() ) {
+            if( mTheme->isStatic() ) {
+                placeStatic();
+            }
+            else if( mPosition > mTargetRect.width() - ( mCurrAnim->frame()->width() - mCurrAnim->hotspot().x() ) ) {
+                mPosition = mTargetRect.width() - ( mCurrAnim->frame()->width() - mCurrAnim->hotspot().x() );
+            }
+
+            if( mHost ) {
+                mHost->targetMoved();
+            }
+        }
+    }
+}
+
+
+void AmorEngine::desktopChanged()
+{
+    mNextTarget = 0;
+    mTargetWin = 0;
+    handleEvent( AmorBehaviour::DesktopChanged );
+    mClock->stop();
+
+    if( mHost ) {
+        mHost->hideCreature();
+    }
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
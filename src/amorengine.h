@@ -0,0 +1,123 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef AMORENGINE_H
+#define AMORENGINE_H
+
+#include "amorbehaviour.h"
+
+#include <QPoint>
+#include <QRandomGenerator>
+#include <QRect>
+#include <qwindowdefs.h>
+
+class AmorAnimation;
+class AmorClock;
+class AmorThemeManager;
+class AmorWindowSystem;
+
+
+/**
+ * The tick and state logic of a creature: which animation plays, on which
+ * window and where. It only talks to the outside world through the window
+ * system, clock and host interfaces, so it runs the same on a live desktop
+ * and in the headless simulator.
+ */
+class AmorEngine
+{
+    public:
+        /**
+         * What the engine needs from whoever displays the creature.
+         */
+        class Host
+        {
+            public:
+                virtual ~Host() {}
+
+                virtual bool hasBubble() const = 0;
+                virtual void dismissBubble() = 0;
+                virtual void showFrame() = 0;           // display the current frame at framePosition()
+                virtual void targetChanged() = 0;       // the creature moved to another target window
+                virtual void targetMoved() = 0;         // the target window moved and took the creature along
+                virtual void hideCreature() = 0;
+                virtual void enteredState() = 0;        // the creature entered another state()
+        };
+
+        AmorEngine(AmorWindowSystem *windowSystem, AmorClock *clock, Host *host = 0);
+
+        void setTheme(const AmorThemeManager *theme);
+        void setOffset(int offset);
+        void setStaticPosition(int position);
+        void setSeed(quint32 seed);
+        void setWindowSystem(AmorWindowSystem *windowSystem);
+
+        void start();
+        void restart();
+        void tick();
+
+        bool activity();
+        void markActive();
+        void pollActivity(bool mayIdle);
+        void dragBy(int dx);
+
+        void windowActivated(WId win);
+        void windowRemoved(WId win);
+        void windowChanged(WId win, bool geometryChanged);
+        void desktopChanged();
+
+        AmorAnimation *animation() const { return mCurrAnim; }
+        AmorAnimation *baseAnimation() const { return mBaseAnim; }
+        int state() const { return mState; }
+        WId target() const { return mTargetWin; }
+        QRect targetRect() const { return mTargetRect; }
+        int position() const { return mPosition; }
+        QPoint framePosition() const;
+        int staticPosition() const;
+        int delay() const;
+
+    protected:
+        bool handleEvent(AmorBehaviour::Event event);
+        void selectAnimation(int state);
+        void placeStatic();
+
+    private:
+        AmorWindowSystem *mWindowSystem;
+        AmorClock *mClock;
+        Host *mHost;
+        const AmorThemeManager *mTheme;
+        QRandomGenerator mRandom;       // Seeded, so that a run can be reproduced
+        WId mTargetWin;                 // The window that the animations sits on
+        QRect mTargetRect;              // The goemetry of the target window
+        WId mNextTarget;                // The window that will become the target
+        AmorAnimation *mBaseAnim;       // The base animation
+        AmorAnimation *mCurrAnim;       // The currently running animation
+        int mPosition;                  // The position of the animation
+        int mState;                     // The behaviour state of the current animation
+        int mPendingState;              // State to enter when the animation ends, or -1
+        bool mInDesktopBottom;          // the animation is not on top of the
+                                        // title bar, but at the bottom of the desktop
+        int mOffset;                    // vertical offset on the title bar
+        int mStaticPos;                 // preferred position of static themes
+        qint64 mActiveTime;             // The time an active event occurred
+        QPoint mCursPos;                // The last recorded position of the pointer
+};
+
+
+#endif
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
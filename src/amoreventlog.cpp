@@ -0,0 +1,353 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amoreventlog.h"
+#include "amorkwindowsystem.h"
+#include "amor_debug.h"
+
+#include <QCursor>
+
+// Log format, all in QDataStream encoding: the magic and a version, then
+// one record after another. A record starts with its time and type; the
+// rest depends on the type, see AmorEventRecorder::write().
+static const char MAGIC[] = "AMOREVTS";
+static const quint32 VERSION = 1;
+
+
+AmorEventRecorder::AmorEventRecorder(QObject *parent)
+  : QObject( parent )
+{
+}
+
+
+bool AmorEventRecorder::open(const QString &fileName)
+{
+    mFile.setFileName( fileName );
+    if( !mFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        qCWarning(AMOR_LOG) << "Could not open event log" << fileName << mFile.errorString();
+        return false;
+    }
+
+    mStream.setDevice( &mFile );
+    mStream.setVersion( QDataStream::Qt_5_12 );
+    mStream.writeRawData( MAGIC, 8 );
+    mStream << VERSION;
+
+    KWindowSystem *windowSystem = KWindowSystem::self();
+    connect( windowSystem, &KWindowSystem::activeWindowChanged, this, &AmorEventRecorder::slotActiveWindowChanged );
+    connect( windowSystem, &KWindowSystem::windowRemoved, this, &AmorEventRecorder::slotWindowRemoved );
+    connect( windowSystem, &KWindowSystem::stackingOrderChanged, this, &AmorEventRecorder::slotStackingOrderChanged );
+    connect( windowSystem, QOverload<WId,NET::Properties,NET::Properties2>::of(&KWindowSystem::windowChanged),
+             this, &AmorEventRecorder::slotWindowChanged );
+    connect( windowSystem, &KWindowSystem::currentDesktopChanged, this, &AmorEventRecorder::slotCurrentDesktopChanged );
+
+    // Start with the window amor sits on at the moment.
+    mElapsed.start();
+    slotActiveWindowChanged( KWindowSystem::activeWindow() );
+
+    return true;
+}
+
+
+AmorEventRecord AmorEventRecorder::record(AmorEventRecord::Type type, WId win) const
+{
+    AmorKWindowSystem windowSystem;
+
+    AmorEventRecord record = AmorEventRecord();
+    record.time = mElapsed.elapsed();
+    record.type = type;
+    record.window = win;
+    record.workArea = windowSystem.workArea();
+
+    if( win ) {
+        record.geometry = windowSystem.frameGeometry( win );
+        if( windowSystem.isMinimized( win ) ) {
+            record.flags |= AmorEventRecord::Minimized;
+        }
+        if( windowSystem.isMaximizedVertically( win ) ) {
+            record.flags |= AmorEventRecord::MaximizedVertically;
+        }
+    }
+
+    return record;
+}
+
+
+void AmorEventRecorder::write(const AmorEventRecord &record)
+{
+    mStream << record.time << record.type;
+
+    switch( record.type ) {
+    case AmorEventRecord::ActiveWindowChanged:
+        mStream << record.window << record.geometry << record.flags << record.workArea;
+        break;
+
+    case AmorEventRecord::WindowRemoved:
+        mStream << record.window;
+        break;
+
+    case AmorEventRecord::StackingOrderChanged:
+        break;
+
+    case AmorEventRecord::WindowChanged:
+        mStream << record.window << record.properties << record.properties2 << record.geometry << record.flags << record.workArea;
+        break;
+
+    case AmorEventRecord::CurrentDesktopChanged:
+        mStream << record.desktop << record.workArea;
+        break;
+    }
+
+    // Keep the log usable if amor is killed while recording.
+    mFile.flush();
+}
+
+
+void AmorEventRecorder::slotActiveWindowChanged(WId win)
+{
+    write( record( AmorEventRecord::ActiveWindowChanged, win ) );
+}
+
+
+void AmorEventRecorder::slotWindowRemoved(WId win)
+{
+    AmorEventRecord removed = AmorEventRecord();
+    removed.time = mElapsed.elapsed();
+    removed.type = AmorEventRecord::WindowRemoved;
+    removed.window = win;
+    write( removed );
+}
+
+
+void AmorEventRecorder::slotStackingOrderChanged()
+{
+    AmorEventRecord stacking = AmorEventRecord();
+    stacking.time = mElapsed.elapsed();
+    stacking.type = AmorEventRecord::StackingOrderChanged;
+    write( stacking );
+}
+
+
+void AmorEventRecorder::slotWindowChanged(WId win, NET::Properties properties, NET::Properties2 properties2)
+{
+    AmorEventRecord changed = record( AmorEventRecord::WindowChanged, win );
+    changed.properties = quint32( properties );
+    changed.properties2 = quint32( properties2 );
+    write( changed );
+}
+
+
+void AmorEventRecorder::slotCurrentDesktopChanged(int desktop)
+{
+    AmorEventRecord changed = record( AmorEventRecord::CurrentDesktopChanged );
+    changed.desktop = desktop;
+    write( changed );
+}
+
+
+AmorEventReplayer::AmorEventReplayer(QObject *parent)
+  : QObject( parent ),
+    mSpeed( 1.0 ),
+    mHasNext( false ),
+    mCount( 0 ),
+    mActive( 0 )
+{
+    mTimer.setSingleShot( true );
+    connect( &mTimer, SIGNAL(timeout()), SLOT(playNext()) );
+}
+
+
+bool AmorEventReplayer::open(const QString &fileName)
+{
+    mFile.setFileName( fileName );
+    if( !mFile.open( QIODevice::ReadOnly ) ) {
+        qCWarning(AMOR_LOG) << "Could not open event log" << fileName << mFile.errorString();
+        return false;
+    }
+
+    mStream.setDevice( &mFile );
+    mStream.setVersion( QDataStream::Qt_5_12 );
+
+    char magic[8];
+    quint32 version = 0;
+    if( mStream.readRawData( magic, 8 ) != 8 || qstrncmp( magic, MAGIC, 8 ) != 0 ) {
+        qCWarning(AMOR_LOG) << fileName << "is not an event log";
+        return false;
+    }
+
+    mStream >> version;
+    if( version != VERSION ) {
+        qCWarning(AMOR_LOG) << "Unsupported event log version" << version;
+        return false;
+    }
+
+    mHasNext = read( &mNext );
+    return true;
+}
+
+
+void AmorEventReplayer::start(qreal speed)
+{
+    mSpeed = speed;
+    mCount = 0;
+    mElapsed.start();
+
+    if( mHasNext ) {
+        schedule();
+    }
+    else {
+        emit finished();
+    }
+}
+
+
+bool AmorEventReplayer::read(AmorEventRecord *record)
+{
+    if( mStream.atEnd() ) {
+        return false;
+    }
+
+    *record = AmorEventRecord();
+    mStream >> record->time >> record->type;
+
+    switch( record->type ) {
+    case AmorEventRecord::ActiveWindowChanged:
+        mStream >> record->window >> record->geometry >> record->flags >> record->workArea;
+        break;
+
+    case AmorEventRecord::WindowRemoved:
+        mStream >> record->window;
+        break;
+
+    case AmorEventRecord::StackingOrderChanged:
+        break;
+
+    case AmorEventRecord::WindowChanged:
+        mStream >> record->window >> record->properties >> record->properties2 >> record->geometry >> record->flags >> record->workArea;
+        break;
+
+    case AmorEventRecord::CurrentDesktopChanged:
+        mStream >> record->desktop >> record->workArea;
+        break;
+
+    default:
+        qCWarning(AMOR_LOG) << "Unknown record in event log:" << record->type;
+        return false;
+    }
+
+    return mStream.status() == QDataStream::Ok;
+}
+
+
+void AmorEventReplayer::schedule()
+{
+    const qint64 due = mSpeed > 0 ? qint64( mNext.time / mSpeed ) : 0;
+    mTimer.start( int( qMax<qint64>( 0, due - mElapsed.elapsed() ) ) );
+}
+
+
+void AmorEventReplayer::playNext()
+{
+    const AmorEventRecord record = mNext;
+    mHasNext = read( &mNext );
+    ++mCount;
+
+    // Update the windows before the creature asks about them.
+    const WId win = record.window;
+    if( record.type == AmorEventRecord::ActiveWindowChanged || record.type == AmorEventRecord::WindowChanged ) {
+        Window &window = mWindows[win];
+        window.geometry = record.geometry;
+        window.flags = record.flags;
+    }
+    if( record.type != AmorEventRecord::WindowRemoved && record.type != AmorEventRecord::StackingOrderChanged ) {
+        mWorkArea = record.workArea;
+    }
+
+    switch( record.type ) {
+    case AmorEventRecord::ActiveWindowChanged:
+        mActive = win;
+        emit activeWindowChanged( win );
+        break;
+
+    case AmorEventRecord::WindowRemoved:
+        mWindows.remove( win );
+        if( mActive == win ) {
+            mActive = 0;
+        }
+        emit windowRemoved( win );
+        break;
+
+    case AmorEventRecord::StackingOrderChanged:
+        emit stackingOrderChanged();
+        break;
+
+    case AmorEventRecord::WindowChanged:
+        emit windowChanged( win, NET::Properties( QFlag( record.properties ) ), NET::Properties2( QFlag( record.properties2 ) ) );
+        break;
+
+    case AmorEventRecord::CurrentDesktopChanged:
+        emit currentDesktopChanged( record.desktop );
+        break;
+    }
+
+    if( mHasNext ) {
+        schedule();
+    }
+    else {
+        qCInfo(AMOR_LOG) << "Replayed" << mCount << "events in" << mElapsed.elapsed() << "ms";
+        emit finished();
+    }
+}
+
+
+WId AmorEventReplayer::activeWindow() const
+{
+    return mActive;
+}
+
+
+QRect AmorEventReplayer::frameGeometry(WId win) const
+{
+    return mWindows.value( win ).geometry;
+}
+
+
+bool AmorEventReplayer::isMaximizedVertically(WId win) const
+{
+    return mWindows.value( win ).flags & AmorEventRecord::MaximizedVertically;
+}
+
+
+bool AmorEventReplayer::isMinimized(WId win) const
+{
+    return mWindows.value( win ).flags & AmorEventRecord::Minimized;
+}
+
+
+QRect AmorEventReplayer::workArea() const
+{
+    return mWorkArea;
+}
+
+
+QPoint AmorEventReplayer::cursorPos() const
+{
+    return QCursor::pos();
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
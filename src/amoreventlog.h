@@ -0,0 +1,146 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef AMOREVENTLOG_H
+#define AMOREVENTLOG_H
+
+#include "amorwindowsystem.h"
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+
+#include <KWindowSystem>
+
+
+/**
+ * The window manager events amor reacts to, as stored in an event log.
+ * Events about a window carry a snapshot of it, so that a log can be
+ * replayed on a display where the recorded windows do not exist.
+ */
+struct AmorEventRecord
+{
+    enum Type { ActiveWindowChanged, WindowRemoved, StackingOrderChanged, WindowChanged, CurrentDesktopChanged };
+    enum WindowFlag { Minimized = 0x1, MaximizedVertically = 0x2 };
+
+    qint64 time;                // milliseconds since the recording started
+    quint8 type;
+    quint64 window;
+    quint32 properties;         // NET::Properties of WindowChanged
+    quint32 properties2;        // NET::Properties2 of WindowChanged
+    qint32 desktop;             // of CurrentDesktopChanged
+    QRect geometry;             // of the window
+    quint8 flags;               // WindowFlags of the window
+    QRect workArea;             // of the current desktop
+};
+
+
+/**
+ * Writes the window manager events to a compact binary log.
+ */
+class AmorEventRecorder : public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit AmorEventRecorder(QObject *parent = 0);
+
+        bool open(const QString &fileName);
+
+    protected slots:
+        void slotActiveWindowChanged(WId win);
+        void slotWindowRemoved(WId win);
+        void slotStackingOrderChanged();
+        void slotWindowChanged(WId win, NET::Properties properties, NET::Properties2 properties2);
+        void slotCurrentDesktopChanged(int desktop);
+
+    protected:
+        AmorEventRecord record(AmorEventRecord::Type type, WId win = 0) const;
+        void write(const AmorEventRecord &record);
+
+    private:
+        QFile mFile;
+        QDataStream mStream;
+        QElapsedTimer mElapsed;
+};
+
+
+/**
+ * Plays an event log back at the recorded pace, faster, or as fast as
+ * possible, and answers the creature's questions about the windows from
+ * the snapshots in the log.
+ */
+class AmorEventReplayer : public QObject, public AmorWindowSystem
+{
+    Q_OBJECT
+
+    public:
+        explicit AmorEventReplayer(QObject *parent = 0);
+
+        bool open(const QString &fileName);
+        void start(qreal speed);        // 0 plays without pauses
+
+        WId activeWindow() const override;
+        QRect frameGeometry(WId win) const override;
+        bool isMaximizedVertically(WId win) const override;
+        bool isMinimized(WId win) const override;
+        QRect workArea() const override;
+        QPoint cursorPos() const override;
+
+    signals:
+        void activeWindowChanged(WId win);
+        void windowRemoved(WId win);
+        void stackingOrderChanged();
+        void windowChanged(WId win, NET::Properties properties, NET::Properties2 properties2);
+        void currentDesktopChanged(int desktop);
+        void finished();
+
+    protected slots:
+        void playNext();
+
+    protected:
+        bool read(AmorEventRecord *record);
+        void schedule();
+
+    private:
+        struct Window
+        {
+            QRect geometry;
+            quint8 flags;
+        };
+
+        QFile mFile;
+        QDataStream mStream;
+        QTimer mTimer;
+        QElapsedTimer mElapsed;
+        qreal mSpeed;
+        AmorEventRecord mNext;          // the record to play next
+        bool mHasNext;
+        qint64 mCount;                  // records played
+        QHash<WId, Window> mWindows;
+        WId mActive;
+        QRect mWorkArea;
+};
+
+
+#endif
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
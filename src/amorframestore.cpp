@@ -0,0 +1,279 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amorframestore.h"
+#include "amor_debug.h"
+
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QVector>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+// The store is a header, followed by the frame index sorted by path, the
+// paths, the mask rectangles and the pixels. It is only read on the host
+// which built it, so all values are in native byte order.
+static const char STORE_MAGIC[8] = { 'A', 'M', 'O', 'R', 'F', 'R', 'M', 'S' };
+static const quint32 STORE_VERSION = 1;
+static const int STORE_ALIGNMENT = 64;
+
+struct StoreHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 count;
+};
+
+struct StoreEntry
+{
+    qint64 modified;            // modification time of the image file in ms
+    qint64 size;                // size of the image file
+    quint64 dataOffset;         // pixels
+    quint32 pathOffset;         // UTF-8 path of the image file
+    quint32 pathLength;
+    quint32 maskOffset;         // mask rectangles as x, y, width, height
+    quint32 maskCount;
+    quint32 width;
+    quint32 height;
+    quint32 bytesPerLine;
+    qint32 offsetX;
+    qint32 offsetY;
+    quint32 reserved;
+};
+
+
+// Whether the entry only refers to data inside the file, so that a damaged
+// or truncated store cannot make find() read past the mapping.
+static bool isValid(const StoreEntry &entry, quint64 size)
+{
+    const quint64 maskSize = quint64( entry.maskCount ) * 4 * sizeof( qint32 );
+    const quint64 dataSize = quint64( entry.bytesPerLine ) * entry.height;
+
+    return quint64( entry.pathOffset ) + entry.pathLength <= size
+        && entry.maskOffset % sizeof( qint32 ) == 0 && entry.maskOffset + maskSize <= size
+        && entry.width <= quint32( INT_MAX / 4 ) && entry.height <= quint32( INT_MAX )
+        && entry.bytesPerLine >= entry.width * 4 && entry.bytesPerLine % 4 == 0 && entry.bytesPerLine <= quint32( INT_MAX )
+        && entry.dataOffset % STORE_ALIGNMENT == 0 && entry.dataOffset <= size && dataSize <= size - entry.dataOffset;
+}
+
+
+// Compares the paths of two entries, which must be valid
+static bool isLess(const uchar *data, const StoreEntry &a, const StoreEntry &b)
+{
+    const int cmp = std::memcmp( data + a.pathOffset, data + b.pathOffset, qMin( a.pathLength, b.pathLength ) );
+    return cmp < 0 || ( cmp == 0 && a.pathLength < b.pathLength );
+}
+
+
+AmorFrameStore::AmorFrameStore()
+  : mData( 0 ),
+    mSize( 0 ),
+    mCount( 0 )
+{
+}
+
+
+AmorFrameStore::~AmorFrameStore()
+{
+    if( mData ) {
+        mFile.unmap( const_cast<uchar *>( mData ) );
+    }
+}
+
+
+bool AmorFrameStore::open(const QString &fileName)
+{
+    if( mData ) {
+        return false;
+    }
+
+    mFile.setFileName( fileName );
+    if( !mFile.open( QIODevice::ReadOnly ) ) {
+        qCDebug(AMOR_LOG) << "Could not open frame store" << fileName;
+        return false;
+    }
+
+    const qint64 size = mFile.size();
+    const uchar *data = size >= qint64( sizeof( StoreHeader ) ) ? mFile.map( 0, size ) : 0;
+    if( !data ) {
+        mFile.close();
+        return false;
+    }
+
+    const StoreHeader *header = reinterpret_cast<const StoreHeader *>( data );
+    bool valid = std::memcmp( header->magic, STORE_MAGIC, sizeof( STORE_MAGIC ) ) == 0 && header->version == STORE_VERSION
+                 && sizeof( StoreHeader ) + quint64( header->count ) * sizeof( StoreEntry ) <= quint64( size );
+
+    // Check every entry once, and that they are sorted for find().
+    const StoreEntry *entries = reinterpret_cast<const StoreEntry *>( data + sizeof( StoreHeader ) );
+    for(quint32 i = 0; valid && i < header->count; ++i) {
+        valid = isValid( entries[i], size ) && ( !i || isLess( data, entries[i-1], entries[i] ) );
+    }
+
+    if( !valid ) {
+        qCDebug(AMOR_LOG) << "Ignoring invalid frame store" << fileName;
+        mFile.unmap( const_cast<uchar *>( data ) );
+        mFile.close();
+        return false;
+    }
+
+    mData = data;
+    mSize = size;
+    mCount = header->count;
+    return true;
+}
+
+
+bool AmorFrameStore::isOpen() const
+{
+    return mData;
+}
+
+
+bool AmorFrameStore::find(const QString &path, Frame *frame) const
+{
+    if( !mData ) {
+        return false;
+    }
+
+    const QByteArray key = path.toUtf8();
+    const StoreEntry *entries = reinterpret_cast<const StoreEntry *>( mData + sizeof( StoreHeader ) );
+    const StoreEntry *end = entries + mCount;
+
+    const StoreEntry *entry = std::lower_bound( entries, end, key, [this](const StoreEntry &e, const QByteArray &k) {
+        const int length = qMin( int( e.pathLength ), k.size() );
+        const int cmp = std::memcmp( mData + e.pathOffset, k.constData(), length );
+        return cmp < 0 || ( cmp == 0 && int( e.pathLength ) < k.size() );
+    } );
+
+    if( entry == end || int( entry->pathLength ) != key.size()
+        || std::memcmp( mData + entry->pathOffset, key.constData(), key.size() ) != 0 )
+    {
+        return false;
+    }
+
+    // Skip frames whose image changed after the store was built.
+    const QFileInfo info( path );
+    if( info.size() != entry->size || info.lastModified().toMSecsSinceEpoch() != entry->modified ) {
+        return false;
+    }
+
+    frame->path = path;
+    frame->image = QImage( mData + entry->dataOffset, entry->width, entry->height, entry->bytesPerLine,
+                           QImage::Format_ARGB32_Premultiplied );
+    frame->offset = QPoint( entry->offsetX, entry->offsetY );
+
+    const qint32 *rects = reinterpret_cast<const qint32 *>( mData + entry->maskOffset );
+    QVector<QRect> mask( entry->maskCount );
+    for(quint32 i = 0; i < entry->maskCount; ++i) {
+        mask[i] = QRect( rects[i*4], rects[i*4+1], rects[i*4+2], rects[i*4+3] );
+    }
+    frame->mask.setRects( mask.constData(), mask.size() );
+
+    return true;
+}
+
+
+static quint64 align(quint64 offset)
+{
+    return ( offset + STORE_ALIGNMENT - 1 ) / STORE_ALIGNMENT * STORE_ALIGNMENT;
+}
+
+
+bool AmorFrameStore::write(const QString &fileName, const QList<Frame> &frames)
+{
+    QList<Frame> sorted = frames;
+    for(Frame &frame : sorted) {
+        frame.image = frame.image.convertToFormat( QImage::Format_ARGB32_Premultiplied );
+    }
+    std::sort( sorted.begin(), sorted.end(), [](const Frame &a, const Frame &b) {
+        return a.path.toUtf8() < b.path.toUtf8();
+    } );
+
+    // Lay out the file: index, paths, masks and finally the pixels.
+    QVector<StoreEntry> entries( sorted.count() );
+    QByteArray paths;
+    QByteArray masks;
+    quint64 offset = sizeof( StoreHeader ) + quint64( entries.size() ) * sizeof( StoreEntry );
+
+    for(int i = 0; i < sorted.count(); ++i) {
+        const QByteArray path = sorted.at( i ).path.toUtf8();
+        StoreEntry &entry = entries[i];
+        std::memset( &entry, 0, sizeof( entry ) );
+        entry.pathOffset = offset + paths.size();
+        entry.pathLength = path.size();
+        paths += path;
+    }
+    offset += paths.size();
+
+    for(int i = 0; i < sorted.count(); ++i) {
+        const QRegion &mask = sorted.at( i ).mask;
+        StoreEntry &entry = entries[i];
+        entry.maskOffset = offset + masks.size();
+        entry.maskCount = mask.rectCount();
+        for(const QRect &rect : mask) {
+            const qint32 values[4] = { rect.x(), rect.y(), rect.width(), rect.height() };
+            masks.append( reinterpret_cast<const char *>( values ), sizeof( values ) );
+        }
+    }
+    offset += masks.size();
+
+    for(int i = 0; i < sorted.count(); ++i) {
+        const Frame &frame = sorted.at( i );
+        const QFileInfo info( frame.path );
+        StoreEntry &entry = entries[i];
+        entry.modified = info.lastModified().toMSecsSinceEpoch();
+        entry.size = info.size();
+        entry.width = frame.image.width();
+        entry.height = frame.image.height();
+        entry.bytesPerLine = frame.image.bytesPerLine();
+        entry.offsetX = frame.offset.x();
+        entry.offsetY = frame.offset.y();
+        entry.dataOffset = offset = align( offset );
+        offset += quint64( entry.bytesPerLine ) * entry.height;
+    }
+
+    QSaveFile file( fileName );
+    if( !file.open( QIODevice::WriteOnly ) ) {
+        return false;
+    }
+
+    StoreHeader header;
+    std::memcpy( header.magic, STORE_MAGIC, sizeof( STORE_MAGIC ) );
+    header.version = STORE_VERSION;
+    header.count = entries.size();
+
+    file.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+    file.write( reinterpret_cast<const char *>( entries.constData() ), entries.size() * sizeof( StoreEntry ) );
+    file.write( paths );
+    file.write( masks );
+
+    for(int i = 0; i < sorted.count(); ++i) {
+        const QImage &image = sorted.at( i ).image;
+        const QByteArray padding( int( entries.at( i ).dataOffset - file.pos() ), '\0' );
+        file.write( padding );
+        file.write( reinterpret_cast<const char *>( image.constBits() ), image.sizeInBytes() );
+    }
+
+    return file.commit();
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef AMORFRAMESTORE_H
+#define AMORFRAMESTORE_H
+
+#include <QFile>
+#include <QImage>
+#include <QList>
+#include <QPoint>
+#include <QRegion>
+#include <QString>
+
+
+/**
+ * A read-only file of decoded, masked and trimmed frames.
+ *
+ * The file is built by amor-themec and memory mapped by every amor process
+ * that uses it, so frames found in it are painted straight from the shared
+ * mapping and cost no private memory. Frames whose image file changed
+ * since the store was built are not returned.
+ */
+class AmorFrameStore
+{
+    public:
+        struct Frame
+        {
+            QString path;       // the image file the frame was decoded from
+            QImage image;       // the trimmed frame, premultiplied ARGB32
+            QPoint offset;      // transparent border trimmed from the frame
+            QRegion mask;       // the opaque part of the frame
+        };
+
+        AmorFrameStore();
+        ~AmorFrameStore();
+
+        bool open(const QString &fileName);
+        bool isOpen() const;
+
+        bool find(const QString &path, Frame *frame) const;
+
+        static bool write(const QString &fileName, const QList<Frame> &frames);
+
+    protected:
+        QFile mFile;
+        const uchar *mData;     // the mapped file
+        qint64 mSize;           // size of the mapping
+        quint32 mCount;         // number of frames in the store
+};
+
+
+#endif
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -0,0 +1,297 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amorkwindowsystem.h"
+
+#include <QCursor>
+#include <QVector>
+
+#include <KWindowInfo>
+#include <KWindowSystem>
+
+
+WId AmorKWindowSystem::activeWindow() const
+{
+    return KWindowSystem::activeWindow();
+}
+
+
+QRect AmorKWindowSystem::frameGeometry(WId win) const
+{
+    return KWindowInfo( win, NET::WMFrameExtents ).frameGeometry();
+}
+
+
+bool AmorKWindowSystem::isMaximizedVertically(WId win) const
+{
+    return KWindowInfo( win, NET::WMState ).hasState( NET::MaxVert );
+}
+
+
+bool AmorKWindowSystem::isMinimized(WId win) const
+{
+    const NET::MappingState mappingState = KWindowInfo( win, NET::WMFrameExtents ).mappingState();
+    return mappingState == NET::Iconic || mappingState == NET::Withdrawn;
+}
+
+
+QRect AmorKWindowSystem::workArea() const
+{
+    return KWindowSystem::workArea( KWindowSystem::currentDesktop() );
+}
+
+
+QPoint AmorKWindowSystem::cursorPos() const
+{
+    return QCursor::pos();
+}
+
+
+/**
+ * The one timer behind all shared frame clocks.
+ */
+class AmorFrameTicker
+{
+    public:
+        static AmorFrameTicker *ticker();
+
+        void add(AmorTimerClock *clock);
+        void remove(AmorTimerClock *clock);
+
+    private:
+        AmorFrameTicker();
+        void schedule(bool fired);
+        void tick();
+
+    private:
+        QTimer mTimer;
+        QVector<AmorTimerClock*> mClocks;   // the running shared clocks
+        QVector<AmorTimerClock*> mDue;      // reused, so that a wakeup does not allocate
+        bool mTicking;
+
+        static AmorFrameTicker *mTicker;
+};
+
+
+AmorFrameTicker *AmorFrameTicker::mTicker = 0;
+
+
+AmorFrameTicker *AmorFrameTicker::ticker()
+{
+    if( !mTicker ) {
+        mTicker = new AmorFrameTicker;
+    }
+
+    return mTicker;
+}
+
+
+AmorFrameTicker::AmorFrameTicker()
+  : mTicking( false )
+{
+    QObject::connect( &mTimer, &QTimer::timeout, [this]() { tick(); } );
+}
+
+
+void AmorFrameTicker::add(AmorTimerClock *clock)
+{
+    if( !mClocks.contains( clock ) ) {
+        mClocks.append( clock );
+    }
+
+    if( !mTicking ) {
+        schedule( false );
+    }
+}
+
+
+void AmorFrameTicker::remove(AmorTimerClock *clock)
+{
+    mClocks.removeOne( clock );
+
+    if( !mTicking ) {
+        schedule( false );
+    }
+}
+
+
+void AmorFrameTicker::schedule(bool fired)
+{
+    qint64 next = -1;
+    for(const AmorTimerClock *clock : qAsConst( mClocks )) {
+        const qint64 remaining = qMax<qint64>( 0, clock->remaining() );
+        if( next < 0 || remaining < next ) {
+            next = remaining;
+        }
+    }
+
+    if( next < 0 ) {
+        mTimer.stop();
+    }
+    // As with the single clocks, the timer repeats, so that it need not be
+    // registered again while the creatures keep the same pace.
+    else if( !fired || !mTimer.isActive() || mTimer.interval() != next ) {
+        mTimer.start( next );
+    }
+}
+
+
+void AmorFrameTicker::tick()
+{
+    // Clocks due within a few milliseconds tick now as well, rather than
+    // waking up again just for them.
+    static const int COALESCE_TIME = 4;
+
+    mDue.resize( 0 );
+    for(AmorTimerClock *clock : qAsConst( mClocks )) {
+        if( clock->remaining() <= COALESCE_TIME ) {
+            mDue.append( clock );
+        }
+    }
+
+    mTicking = true;
+    for(AmorTimerClock *clock : qAsConst( mDue )) {
+        if( mClocks.contains( clock ) ) {   // not stopped by an earlier one
+            clock->fire();
+        }
+    }
+    mTicking = false;
+
+    schedule( true );
+}
+
+
+
+AmorTimerClock::AmorTimerClock()
+  : mStarted( 0 ),
+    mDue( 0 ),
+    mActual( 0 ),
+    mInterval( 0 ),
+    mFired( false ),
+    mShared( false ),
+    mActive( false )
+{
+    // The timer repeats, so that a frame with the same delay as the one
+    // before does not have to register a new timer, which allocates.
+    connect( &mTimer, &QTimer::timeout, this, &AmorTimerClock::fire );
+    mElapsed.start();
+}
+
+
+AmorTimerClock::~AmorTimerClock()
+{
+    stop();
+}
+
+
+void AmorTimerClock::setShared(bool shared)
+{
+    if( mShared == shared ) {
+        return;
+    }
+
+    // Carry a running frame over to the other timer
+    const bool active = isActive();
+    const int remaining = qMax<qint64>( 0, mDue - mElapsed.elapsed() );
+    stop();
+
+    mShared = shared;
+    if( active ) {
+        start( remaining );
+    }
+}
+
+
+qint64 AmorTimerClock::elapsed() const
+{
+    return mElapsed.elapsed();
+}
+
+
+void AmorTimerClock::start(int msec)
+{
+    const qint64 now = mElapsed.elapsed();
+    mInterval = msec;
+
+    if( mShared ) {
+        // Started from the timeout, the next frame counts from when the
+        // last one was due.
+        if( !mFired ) {
+            mStarted = now;
+        }
+        schedule( now );
+        mActive = true;
+        AmorFrameTicker::ticker()->add( this );
+    }
+    // Restarting from the timeout, the running timer is already due again
+    // after the same interval.
+    else if( !mFired || !mTimer.isActive() || mTimer.interval() != msec ) {
+        mTimer.start( msec );
+        mStarted = now;
+        mDue = now + msec;
+    }
+    mFired = false;
+}
+
+
+void AmorTimerClock::stop()
+{
+    if( mActive ) {
+        mActive = false;
+        AmorFrameTicker::ticker()->remove( this );
+    }
+
+    mTimer.stop();
+    mFired = false;
+}
+
+
+bool AmorTimerClock::isActive() const
+{
+    return mShared ? mActive : mTimer.isActive();
+}
+
+
+void AmorTimerClock::schedule(qint64 now)
+{
+    // Once the frame is overdue before it even started, the timer does not
+    // catch up but starts over.
+    mDue = mStarted + mInterval;
+    if( mDue < now ) {
+        mStarted = now;
+        mDue = now + mInterval;
+    }
+}
+
+
+void AmorTimerClock::fire()
+{
+    const qint64 now = mElapsed.elapsed();
+    mActual = now - mStarted;
+    mFired = true;
+
+    // The timer repeats until it is started again or stopped, and so does
+    // a shared clock: the next frame is due one interval after this one was
+    // due, not after it ran.
+    mStarted = mDue;
+    schedule( now );
+
+    emit timeout();
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
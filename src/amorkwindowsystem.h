@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef AMORKWINDOWSYSTEM_H
+#define AMORKWINDOWSYSTEM_H
+
+#include "amorwindowsystem.h"
+
+#include <QElapsedTimer>
+#include <QTimer>
+
+
+/**
+ * Answers the creature's questions about the desktop from KWindowSystem.
+ */
+class AmorKWindowSystem : public AmorWindowSystem
+{
+    public:
+        WId activeWindow() const override;
+        QRect frameGeometry(WId win) const override;
+        bool isMaximizedVertically(WId win) const override;
+        bool isMinimized(WId win) const override;
+        QRect workArea() const override;
+        QPoint cursorPos() const override;
+};
+
+
+/**
+ * Wall clock time and a repeating QTimer as frame timer.
+ *
+ * A shared clock has no timer of its own: one timer for the whole process
+ * ticks all shared clocks which are due at about the same time in a single
+ * wakeup. The creatures in overlay mode use shared clocks.
+ */
+class AmorTimerClock : public QObject, public AmorClock
+{
+    Q_OBJECT
+
+    public:
+        AmorTimerClock();
+        ~AmorTimerClock();
+
+        void setShared(bool shared);
+        bool isShared() const { return mShared; }
+
+        int interval() const { return mInterval; }
+        qint64 actualInterval() const { return mActual; }   // of the frame which fired last
+
+        qint64 elapsed() const override;
+        void start(int msec) override;
+        void stop() override;
+        bool isActive() const override;
+
+    signals:
+        void timeout();
+
+    private:
+        friend class AmorFrameTicker;
+        qint64 remaining() const { return mDue - mElapsed.elapsed(); }
+        void schedule(qint64 now);
+        void fire();
+
+    private:
+        QTimer mTimer;
+        QElapsedTimer mElapsed;
+        qint64 mStarted;                // when the current frame interval began
+        qint64 mDue;                    // and when it is due
+        qint64 mActual;                 // how long the last frame took from its start until it fired
+        int mInterval;
+        bool mFired;                    // the timer expired since it was last started
+        bool mShared;                   // ticked by the process wide frame ticker
+        bool mActive;                   // a shared clock is running
+};
+
+
+#endif
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
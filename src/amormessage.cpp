@@ -0,0 +1,39 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amormessage.h"
+
+
+QDBusArgument &operator<<(QDBusArgument &argument, const AmorMessage &message)
+{
+    argument.beginStructure();
+    argument << message.text << message.msec;
+    argument.endStructure();
+    return argument;
+}
+
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, AmorMessage &message)
+{
+    argument.beginStructure();
+    argument >> message.text >> message.msec;
+    argument.endStructure();
+    return argument;
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
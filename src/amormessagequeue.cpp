@@ -0,0 +1,236 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amormessagequeue.h"
+
+#include <KLocalizedString>
+
+#define TIP_LIMIT 5     // tips pending at most, application tips included
+
+
+AmorMessageQueue::AmorMessageQueue(int capacity, OverflowPolicy policy)
+  : mCapacity( qMax( 2, capacity ) ),
+    mPolicy( policy ),
+    mHeadShown( false ),
+    mHasSummary( false ),
+    mCollapsed( 0 )
+{
+    resetStats();
+}
+
+
+void AmorMessageQueue::setCapacity(int capacity)
+{
+    // The head and a summary need room at least.
+    mCapacity = qMax( 2, capacity );
+}
+
+
+void AmorMessageQueue::setOverflowPolicy(OverflowPolicy policy)
+{
+    mPolicy = policy;
+}
+
+
+AmorMessageQueue::OverflowPolicy AmorMessageQueue::overflowPolicy(const QString &name)
+{
+    if( name.compare( QLatin1String( "Summarize" ), Qt::CaseInsensitive ) == 0 ) {
+        return Summarize;
+    }
+    if( name.compare( QLatin1String( "Reject" ), Qt::CaseInsensitive ) == 0 ) {
+        return Reject;
+    }
+
+    return DropOldest;
+}
+
+
+bool AmorMessageQueue::enqueue(const QueueItem &item)
+{
+    const int first = mHeadShown ? 1 : 0;
+    int tips = 0;
+    for(int i = 0; i < mItems.count(); ++i) {
+        const QueueItem &pending = mItems.at( i );
+        if( i >= first && pending.type() == item.type() && pending.text() == item.text() ) {
+            ++mDuplicates;
+            return false;
+        }
+        if( pending.type() == QueueItem::Tip ) {
+            ++tips;
+        }
+    }
+
+    if( item.type() == QueueItem::Tip && tips >= TIP_LIMIT ) {
+        ++mDropped;
+        return false;
+    }
+
+    if( mItems.count() >= mCapacity ) {
+        const qint64 summarized = mSummarized;
+        if( !makeRoom( item ) ) {
+            // A message folded into the summary still reaches the user
+            return mSummarized != summarized;
+        }
+    }
+
+    mItems.insert( insertPosition( item.type() ), item );
+    ++mEnqueued;
+    mMaxDepth = qMax( mMaxDepth, mItems.count() );
+    return true;
+}
+
+
+void AmorMessageQueue::dequeue()
+{
+    if( mItems.isEmpty() ) {
+        return;
+    }
+
+    mItems.removeFirst();
+    mHeadShown = false;
+    if( mItems.isEmpty() ) {
+        mHasSummary = false;
+        mCollapsed = 0;
+    }
+}
+
+
+void AmorMessageQueue::setHeadShown(bool shown)
+{
+    mHeadShown = shown && !mItems.isEmpty();
+
+    // A summary in the bubble no longer takes more messages.
+    if( mHeadShown && mHasSummary && mItems.count() == 1 ) {
+        mHasSummary = false;
+        mCollapsed = 0;
+    }
+}
+
+
+void AmorMessageQueue::clear()
+{
+    mItems.clear();
+    mHeadShown = false;
+    mHasSummary = false;
+    mCollapsed = 0;
+}
+
+
+int AmorMessageQueue::insertPosition(QueueItem::ItemType type) const
+{
+    // Behind the messages, or behind everything if a tip, but never in
+    // front of the shown head nor behind the summary.
+    const int first = mHeadShown ? 1 : 0;
+    const int end = mHasSummary ? mItems.count() - 1 : mItems.count();
+    if( type == QueueItem::Tip ) {
+        return qMax( first, end );
+    }
+
+    int position = first;
+    while( position < end && mItems.at( position ).type() == QueueItem::Talk ) {
+        ++position;
+    }
+
+    return position;
+}
+
+
+bool AmorMessageQueue::makeRoom(const QueueItem &item)
+{
+    const int first = mHeadShown ? 1 : 0;
+
+    // Tips never displace messages; drop the oldest pending tip for either.
+    for(int i = first; i < mItems.count(); ++i) {
+        if( mItems.at( i ).type() == QueueItem::Tip && mPolicy != Reject ) {
+            mItems.removeAt( i );
+            ++mDropped;
+            return true;
+        }
+    }
+
+    if( item.type() == QueueItem::Tip || mPolicy == Reject ) {
+        ++mRejected;
+        return false;
+    }
+
+    if( mPolicy == Summarize ) {
+        // The new message and the last pending one go into the summary.
+        if( !mHasSummary ) {
+            if( mItems.count() <= first ) {
+                ++mRejected;
+                return false;
+            }
+            mItems.removeLast();
+            mHasSummary = true;
+            mCollapsed = 1;
+            ++mSummarized;
+            mItems.append( QueueItem( QueueItem::Talk, QString() ) );
+        }
+        ++mCollapsed;
+        ++mSummarized;
+        updateSummary();
+        return false;
+    }
+
+    // DropOldest
+    if( mItems.count() <= first ) {
+        ++mRejected;
+        return false;
+    }
+    mItems.removeAt( first );
+    if( mItems.count() == first ) {
+        mHasSummary = false;
+        mCollapsed = 0;
+    }
+    ++mDropped;
+    return true;
+}
+
+
+void AmorMessageQueue::updateSummary()
+{
+    mItems.last() = QueueItem( QueueItem::Talk, i18np( "One more message", "%1 more messages", mCollapsed ) );
+}
+
+
+QVariantMap AmorMessageQueue::stats() const
+{
+    QVariantMap map;
+    map[QStringLiteral( "queueDepth" )] = mItems.count();
+    map[QStringLiteral( "queueMaxDepth" )] = mMaxDepth;
+    map[QStringLiteral( "queueCapacity" )] = mCapacity;
+    map[QStringLiteral( "queueEnqueued" )] = mEnqueued;
+    map[QStringLiteral( "queueDuplicates" )] = mDuplicates;
+    map[QStringLiteral( "queueDropped" )] = mDropped;
+    map[QStringLiteral( "queueRejected" )] = mRejected;
+    map[QStringLiteral( "queueSummarized" )] = mSummarized;
+    return map;
+}
+
+
+void AmorMessageQueue::resetStats()
+{
+    mEnqueued = 0;
+    mDuplicates = 0;
+    mDropped = 0;
+    mRejected = 0;
+    mSummarized = 0;
+    mMaxDepth = mItems.count();
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef AMORMESSAGEQUEUE_H
+#define AMORMESSAGEQUEUE_H
+
+#include "queueitem.h"
+
+#include <QList>
+#include <QVariantMap>
+
+
+/**
+ * The messages and tips waiting for the bubble.
+ *
+ * The queue holds a bounded number of items. Messages are queued ahead of
+ * tips, identical pending texts are only queued once, and what happens
+ * to an item that does not fit is up to the overflow policy. The head is
+ * the item in the bubble while it is shown, and is never displaced.
+ */
+class AmorMessageQueue
+{
+    public:
+        enum OverflowPolicy {
+            DropOldest,     // make room by dropping the oldest tip, or else the oldest message
+            Summarize,      // collapse the messages which do not fit into one summary
+            Reject          // refuse items while the queue is full
+        };
+
+        explicit AmorMessageQueue(int capacity = 20, OverflowPolicy policy = DropOldest);
+
+        void setCapacity(int capacity);
+        void setOverflowPolicy(OverflowPolicy policy);
+        static OverflowPolicy overflowPolicy(const QString &name);
+
+        /**
+         * Queues @p item.
+         * @return false if it was a duplicate, or was dropped or rejected;
+         * a message folded into the summary counts as queued
+         */
+        bool enqueue(const QueueItem &item);
+        void dequeue();
+        void clear();
+
+        QueueItem &head() { return mItems.first(); }
+        const QueueItem &head() const { return mItems.first(); }
+        bool isEmpty() const { return mItems.isEmpty(); }
+        int count() const { return mItems.count(); }
+        void setHeadShown(bool shown);
+
+        QVariantMap stats() const;
+        void resetStats();
+
+    protected:
+        int insertPosition(QueueItem::ItemType type) const;
+        bool makeRoom(const QueueItem &item);
+        void updateSummary();
+
+    private:
+        QList<QueueItem> mItems;
+        int mCapacity;
+        OverflowPolicy mPolicy;
+        bool mHeadShown;            // the head is in the bubble
+        bool mHasSummary;           // the last item stands for the collapsed messages
+        int mCollapsed;             // number of messages in the summary
+
+        qint64 mEnqueued;
+        qint64 mDuplicates;
+        qint64 mDropped;
+        qint64 mRejected;
+        qint64 mSummarized;
+        int mMaxDepth;
+};
+
+
+#endif
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
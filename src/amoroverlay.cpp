@@ -0,0 +1,116 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amoroverlay.h"
+#include "amorstats.h"
+
+#include <QChildEvent>
+#include <QGuiApplication>
+#include <QScreen>
+
+#include <KWindowSystem>
+
+QHash<QScreen*, AmorOverlay*> AmorOverlay::mOverlays;
+
+
+AmorOverlay::AmorOverlay(QScreen *screen)
+  : QWidget( 0, Qt::X11BypassWindowManagerHint | Qt::WindowStaysOnTopHint | Qt::FramelessWindowHint
+                | Qt::WindowTransparentForInput | Qt::WindowDoesNotAcceptFocus ),
+    mScreen( screen )
+{
+    setAttribute( Qt::WA_TranslucentBackground );
+    setAttribute( Qt::WA_ShowWithoutActivating );
+
+    setGeometry( screen->geometry() );
+    connect( screen, &QScreen::geometryChanged, this, QOverload<const QRect &>::of( &QWidget::setGeometry ) );
+    connect( screen, &QObject::destroyed, this, &AmorOverlay::slotScreenDestroyed );
+
+    show();
+    KWindowSystem::setOnAllDesktops( winId(), true );
+}
+
+
+AmorOverlay::~AmorOverlay()
+{
+    if( mScreen ) {
+        mOverlays.remove( mScreen );
+    }
+}
+
+
+bool AmorOverlay::isSupported()
+{
+    // Without a compositor the transparent parts of the overlay would be black.
+    return KWindowSystem::compositingActive();
+}
+
+
+AmorOverlay *AmorOverlay::overlay(QScreen *screen)
+{
+    AmorOverlay *overlay = mOverlays.value( screen );
+    if( !overlay ) {
+        overlay = new AmorOverlay( screen );
+        mOverlays.insert( screen, overlay );
+    }
+
+    return overlay;
+}
+
+
+AmorOverlay *AmorOverlay::overlayAt(const QPoint &pos)
+{
+    QScreen *screen = QGuiApplication::screenAt( pos );
+    return overlay( screen ? screen : QGuiApplication::primaryScreen() );
+}
+
+
+bool AmorOverlay::event(QEvent *event)
+{
+    // The updates of all widgets on the overlay are flushed together.
+    if( event->type() == QEvent::UpdateRequest ) {
+        AmorStats::stats()->xRequests();
+    }
+
+    return QWidget::event( event );
+}
+
+
+void AmorOverlay::childEvent(QChildEvent *event)
+{
+    QWidget::childEvent( event );
+
+    // An overlay whose screen went away lives on only until its widgets
+    // have moved to the overlay of another screen.
+    if( event->removed() && !mScreen && children().isEmpty() ) {
+        deleteLater();
+    }
+}
+
+
+void AmorOverlay::slotScreenDestroyed()
+{
+    mOverlays.remove( mScreen );
+    mScreen = 0;
+    hide();
+
+    if( children().isEmpty() ) {
+        deleteLater();
+    }
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -16,66 +16,216 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 #include "amorpixmapmanager.h"
+#include "amorstartupprofile.h"
 
-#include <QPixmap>
-#include <QBitmap>
+#include <QImage>
+#include <QVector>
 
 AmorPixmapManager *AmorPixmapManager::mManager = 0;
 
 
 AmorPixmapManager::AmorPixmapManager()
-  : mPixmapDir(QLatin1String( "." ))
+  : mHits( 0 ),
+    mMisses( 0 )
 {
 }
 
 
 AmorPixmapManager::~AmorPixmapManager()
 {
-    qDeleteAll( mPixmaps );
+    qDeleteAll( mFrames );
 }
 
 
-void AmorPixmapManager::setPixmapDir(const QString &dir)
+bool AmorPixmapManager::setFrameStore(const QString &fileName)
 {
-    mPixmapDir = dir;
+    // Frames are painted straight from the mapping, so once opened the
+    // store stays for the lifetime of the process.
+    if( fileName.isEmpty() || mStore.isOpen() ) {
+        return mStore.isOpen();
+    }
+
+    return mStore.open( fileName );
+}
+
+
+const QImage* AmorPixmapManager::load(const QString &path)
+{
+    QImage *image = mFrames.value( path );
+
+    if( !image ) {
+        // frame has not yet been loaded.
+        AmorStartupProfile::Scope scope( "pixmaps" );
+        AmorFrameStore::Frame frame;
+        const bool mapped = mStore.find( path, &frame );
+        if( !mapped ) {
+            QHash<QString, AmorFrameStore::Frame>::const_iterator it = mDecoded.constFind( path );
+            if( it != mDecoded.constEnd() ) {
+                frame = *it;
+            }
+            else if( !decode( path, &frame ) ) {
+                return 0;
+            }
+        }
+        ++mMisses;
+
+        Entry entry;
+        entry.path = path;
+        entry.offset = frame.offset;
+        entry.mask = frame.mask;
+        entry.ref = 0;
+        entry.mapped = mapped;
+
+        image = new QImage( frame.image );
+        mFrames.insert( path, image );
+        mEntries.insert( image, entry );
+    }
+    else {
+        ++mHits;
+    }
+
+    ++mEntries[image].ref;
+    return image;
+}
+
+
+void AmorPixmapManager::release(const QImage *frame)
+{
+    QHash<const QImage*, Entry>::iterator it = mEntries.find( frame );
+    if( it == mEntries.end() ) {
+        return;
+    }
+
+    if( --it->ref == 0 ) {
+        mFrames.remove( it->path );
+        mEntries.erase( it );
+        delete frame;
+    }
 }
 
 
-void AmorPixmapManager::reset()
+QPoint AmorPixmapManager::offset(const QImage *frame) const
 {
-    mPixmapDir = QLatin1Char( '.' );
-    qDeleteAll( mPixmaps );
-    mPixmaps.clear();
+    // Look the entry up in place; value() would copy it, path and all.
+    QHash<const QImage*, Entry>::const_iterator it = mEntries.constFind( frame );
+    return it != mEntries.constEnd() ? it->offset : QPoint();
 }
 
 
-const QPixmap* AmorPixmapManager::load(const QString & img)
+QRegion AmorPixmapManager::mask(const QImage *frame) const
 {
-    QHash<QString, QPixmap*>::const_iterator it = mPixmaps.constFind( img );
-    QPixmap *pixmap = it != mPixmaps.constEnd() ? *it : 0;
+    QHash<const QImage*, Entry>::const_iterator it = mEntries.constFind( frame );
+    return it != mEntries.constEnd() ? it->mask : QRegion();
+}
 
-    if( !pixmap ) {
-        // pixmap has not yet been loaded.
-        QString path = mPixmapDir + QLatin1String( "/" ) + img;
-        pixmap = new QPixmap( path );
 
-        if( !pixmap->isNull() ) {
-            pixmap->setMask(pixmap->createHeuristicMask(true));
-            mPixmaps[img] = pixmap;
+qint64 AmorPixmapManager::decodedBytes() const
+{
+    qint64 bytes = 0;
+    for(QHash<const QImage*, Entry>::const_iterator it = mEntries.constBegin(); it != mEntries.constEnd(); ++it) {
+        if( !it->mapped ) {
+            bytes += it.key()->sizeInBytes();
         }
-        else {
-            delete pixmap;
-            pixmap = 0;
+    }
+
+    return bytes;
+}
+
+
+qint64 AmorPixmapManager::mappedBytes() const
+{
+    qint64 bytes = 0;
+    for(QHash<const QImage*, Entry>::const_iterator it = mEntries.constBegin(); it != mEntries.constEnd(); ++it) {
+        if( it->mapped ) {
+            bytes += it.key()->sizeInBytes();
         }
     }
 
-    return pixmap;
+    return bytes;
 }
 
 
-const QPixmap* AmorPixmapManager::pixmap(const QString & img) const
+qint64 AmorPixmapManager::maskBytes() const
 {
-    return mPixmaps.contains( img ) ? mPixmaps[ img ] : 0;
+    qint64 bytes = 0;
+    for(QHash<const QImage*, Entry>::const_iterator it = mEntries.constBegin(); it != mEntries.constEnd(); ++it) {
+        bytes += it->mask.rectCount() * sizeof( QRect );
+    }
+
+    return bytes;
+}
+
+
+bool AmorPixmapManager::isMapped(const QImage *frame) const
+{
+    QHash<const QImage*, Entry>::const_iterator it = mEntries.constFind( frame );
+    return it != mEntries.constEnd() && it->mapped;
+}
+
+
+qint64 AmorPixmapManager::maskBytes(const QImage *frame) const
+{
+    QHash<const QImage*, Entry>::const_iterator it = mEntries.constFind( frame );
+    return it != mEntries.constEnd() ? it->mask.rectCount() * sizeof( QRect ) : 0;
+}
+
+
+bool AmorPixmapManager::decode(const QString &path, AmorFrameStore::Frame *frame)
+{
+    QImage image( path );
+    if( image.isNull() ) {
+        return false;
+    }
+
+    // Make the background colour found in the corners transparent, just
+    // like QPixmap::createHeuristicMask() did.
+    const QImage heuristicMask = image.createHeuristicMask( true );
+    image = image.convertToFormat( QImage::Format_ARGB32_Premultiplied );
+
+    QVector<QRect> rects;
+    for(int y = 0; y < image.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>( image.scanLine( y ) );
+        for(int x = 0; x < image.width(); ++x) {
+            if( !heuristicMask.pixelIndex( x, y ) ) {
+                line[x] = 0;
+            }
+        }
+
+        // Collect the opaque spans of the line for the mask.
+        for(int x = 0; x < image.width(); ) {
+            if( !qAlpha( line[x] ) ) {
+                ++x;
+                continue;
+            }
+
+            const int start = x;
+            while( x < image.width() && qAlpha( line[x] ) ) {
+                ++x;
+            }
+            rects.append( QRect( start, y, x - start, 1 ) );
+        }
+    }
+
+    QRegion mask;
+    mask.setRects( rects.constData(), rects.size() );
+
+    // Trim the transparent border, so the widget showing this frame
+    // only covers its visible pixels. The offset is remembered to
+    // keep the hotspots of the animations pointing at the same spot.
+    frame->path = path;
+    frame->offset = QPoint();
+
+    const QRect bounds = mask.boundingRect();
+    if( !bounds.isEmpty() && bounds != image.rect() ) {
+        image = image.copy( bounds );
+        mask.translate( -bounds.topLeft() );
+        frame->offset = bounds.topLeft();
+    }
+
+    frame->image = image;
+    frame->mask = mask;
+
+    return true;
 }
 
 
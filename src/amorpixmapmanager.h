@@ -18,31 +18,78 @@
 #ifndef AMORPIXMAPMANAGER_H
 #define AMORPIXMAPMANAGER_H
 
+#include "amorframestore.h"
+
 #include <QHash>
+#include <QPoint>
+#include <QRegion>
 #include <QString>
+#include <QStringList>
 
-class QPixmap;
+class QImage;
 
 
+/**
+ * Process wide cache of the frames of all loaded themes.
+ *
+ * Frames are reference counted, so creatures using the same theme share
+ * one copy of each frame, and a frame is freed once no animation uses it.
+ * Frames are kept as premultiplied ARGB32 images, which is what the raster
+ * paint engine draws fastest and what lets them be painted directly from
+ * a shared frame store.
+ */
 class AmorPixmapManager
 {
     public:
         AmorPixmapManager();
         virtual ~AmorPixmapManager();
 
-        void setPixmapDir(const QString &dir);
+        bool setFrameStore(const QString &fileName);
+
+        const QImage *load(const QString &path);
+        void release(const QImage *frame);
+
+        // Frames decoded in another thread, which load() takes instead of
+        // decoding them again; an empty hash drops those not taken.
+        void setDecoded(const QHash<QString, AmorFrameStore::Frame> &frames) { mDecoded = frames; }
+        QStringList paths() const { return mFrames.keys(); }
 
-        void reset();
+        QPoint offset(const QImage *frame) const;
+        QRegion mask(const QImage *frame) const;
 
-        const QPixmap *load(const QString & img);
-        const QPixmap *pixmap(const QString & img) const;
+        // Cache statistics
+        qint64 hits() const { return mHits; }
+        qint64 misses() const { return mMisses; }
+        int frameCount() const { return mEntries.size(); }
+        qint64 decodedBytes() const;    // frames decoded into this process
+        qint64 mappedBytes() const;     // frames painted from the frame store
+        qint64 maskBytes() const;       // shapes of all frames
+
+        // Memory of a single frame
+        bool isMapped(const QImage *frame) const;
+        qint64 maskBytes(const QImage *frame) const;
+
+        static bool decode(const QString &path, AmorFrameStore::Frame *frame);
 
         static AmorPixmapManager* manager();
 
-    public:
-        QString mPixmapDir;                  // get pixmaps from here
-        QHash<QString, QPixmap*> mPixmaps;   // list of pixmaps
-        static AmorPixmapManager *mManager;  // static pointer to instance
+    protected:
+        struct Entry
+        {
+            QString path;       // the file the frame was loaded from
+            QPoint offset;      // transparent border trimmed from the frame
+            QRegion mask;       // the opaque part of the frame
+            int ref;            // number of animation frames using it
+            bool mapped;        // painted from the frame store
+        };
+
+        AmorFrameStore mStore;                     // optional shared frames
+        QHash<QString, QImage*> mFrames;           // loaded frames by path
+        QHash<const QImage*, Entry> mEntries;      // bookkeeping of each frame
+        QHash<QString, AmorFrameStore::Frame> mDecoded; // see setDecoded()
+        qint64 mHits;                              // loads of frames already loaded
+        qint64 mMisses;                            // loads which mapped or decoded a frame
+        static AmorPixmapManager *mManager;        // static pointer to instance
 };
 
 
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amorpreview.h"
+#include "amoranimation.h"
+#include "amorpixmapmanager.h"
+
+#include <QApplication>
+#include <QPainter>
+#include <QPointer>
+#include <QRunnable>
+#include <QSet>
+#include <QSettings>
+#include <QThreadPool>
+
+#define PREVIEW_SIZE 96     // smallest size of the preview
+#define LOAD_DELAY 250      // ms the highlight has to stay on a theme before it is read
+
+
+// Decodes the base frames of a theme which are not loaded yet
+class AmorPreviewJob : public QRunnable
+{
+    public:
+        AmorPreviewJob(AmorPreview *preview, int generation, const QString &path, const QStringList &loaded)
+          : mPreview( preview ),
+            mGeneration( generation ),
+            mPath( path ),
+            mLoaded( loaded.cbegin(), loaded.cend() )
+        {
+        }
+
+        void run() override
+        {
+            // The theme manager only finds the pixmap directory here.
+            AmorThemeManager theme;
+            QHash<QString, AmorFrameStore::Frame> frames;
+            if( theme.setTheme( mPath ) ) {
+                QSettings config( mPath, QSettings::IniFormat );
+                QStringList animations = config.value( QStringLiteral( "Config/Base" ) ).toStringList();
+                if( animations.isEmpty() ) {
+                    animations.append( QStringLiteral( "Base" ) );
+                }
+
+                for(const QString &animation : qAsConst( animations )) {
+                    const QStringList sequence = config.value( animation + QLatin1String( "/Sequence" ) ).toStringList();
+                    for(const QString &image : sequence) {
+                        const QString path = theme.pixmapPath() + QLatin1Char( '/' ) + image;
+                        AmorFrameStore::Frame frame;
+                        if( !mLoaded.contains( path ) && !frames.contains( path ) && AmorPixmapManager::decode( path, &frame ) ) {
+                            frames.insert( path, frame );
+                        }
+                    }
+                }
+            }
+
+            // The dialog may be closed by now.
+            QPointer<AmorPreview> preview = mPreview;
+            const int generation = mGeneration;
+            QMetaObject::invokeMethod( qApp, [preview, generation, frames]() {
+                if( preview ) {
+                    preview->setFrames( generation, frames );
+                }
+            }, Qt::QueuedConnection );
+        }
+
+    private:
+        QPointer<AmorPreview> mPreview;
+        int mGeneration;
+        QString mPath;
+        QSet<QString> mLoaded;      // frames the pixmap manager has already
+};
+
+
+AmorPreview::AmorPreview(QWidget *parent)
+  : QWidget( parent ),
+    mGeneration( 0 ),
+    mTheme( 0 ),
+    mAnim( 0 )
+{
+    mLoadTimer.setSingleShot( true );
+    mLoadTimer.setInterval( LOAD_DELAY );
+    connect( &mLoadTimer, SIGNAL(timeout()), SLOT(slotLoad()) );
+
+    mTimer.setSingleShot( true );
+    connect( &mTimer, SIGNAL(timeout()), SLOT(slotTimeout()) );
+}
+
+
+AmorPreview::~AmorPreview()
+{
+    delete mTheme;
+}
+
+
+void AmorPreview::setTheme(const QString &path, const QImage &icon)
+{
+    mTimer.stop();
+    mAnim = 0;
+    mPath = path;
+    mIcon = icon;
+    ++mGeneration;
+
+    // The frames of the previous theme stay loaded until the new ones are,
+    // as the themes may share some.
+    mLoadTimer.start();
+    update();
+}
+
+
+void AmorPreview::slotLoad()
+{
+    QThreadPool::globalInstance()->start( new AmorPreviewJob( this, mGeneration, mPath, AmorPixmapManager::manager()->paths() ) );
+}
+
+
+void AmorPreview::setFrames(int generation, const QHash<QString, AmorFrameStore::Frame> &frames)
+{
+    if( generation != mGeneration ) {
+        return;     // another theme was highlighted meanwhile
+    }
+
+    AmorPixmapManager *manager = AmorPixmapManager::manager();
+    manager->setDecoded( frames );
+    AmorThemeManager *theme = new AmorThemeManager;
+    if( theme->setTheme( mPath ) && theme->readGroup( AmorThemeManager::BaseGroup ) ) {
+        mAnim = theme->random( AmorThemeManager::BaseGroup );
+    }
+    manager->setDecoded( QHash<QString, AmorFrameStore::Frame>() );
+
+    delete mTheme;
+    mTheme = theme;
+
+    if( mAnim ) {
+        mAnim->reset();
+        if( isVisible() ) {
+            mTimer.start( mAnim->delay() );
+        }
+    }
+
+    updateGeometry();
+    update();
+}
+
+
+QSize AmorPreview::sizeHint() const
+{
+    return mTheme ? mTheme->maximumSize().expandedTo( QSize( PREVIEW_SIZE, PREVIEW_SIZE ) )
+                  : QSize( PREVIEW_SIZE, PREVIEW_SIZE );
+}
+
+
+void AmorPreview::paintEvent(QPaintEvent *)
+{
+    QPainter painter( this );
+
+    if( !mAnim || !mAnim->frame() ) {
+        if( !mIcon.isNull() ) {
+            painter.drawImage( ( width() - mIcon.width() )/2, ( height() - mIcon.height() )/2, mIcon );
+        }
+        return;
+    }
+
+    // The hotspot sits at the bottom in the middle, where the creature would
+    // stand on the title bar of a window.
+    const QPoint hotspot( width()/2, height() - height()/4 );
+    painter.drawImage( hotspot - mAnim->hotspot(), *mAnim->frame() );
+}
+
+
+void AmorPreview::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent( event );
+
+    if( mAnim ) {
+        mTimer.start( mAnim->delay() );
+    }
+}
+
+
+void AmorPreview::hideEvent(QHideEvent *event)
+{
+    mTimer.stop();
+
+    QWidget::hideEvent( event );
+}
+
+
+void AmorPreview::slotTimeout()
+{
+    // Move on to another base animation once one is through.
+    if( !mAnim->next() ) {
+        mAnim = mTheme->random( AmorThemeManager::BaseGroup );
+        mAnim->reset();
+    }
+
+    update();
+    mTimer.start( mAnim->delay() );
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
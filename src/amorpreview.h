@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef AMORPREVIEW_H
+#define AMORPREVIEW_H
+
+#include "amorframestore.h"
+#include "amorthememanager.h"
+
+#include <QHash>
+#include <QImage>
+#include <QTimer>
+#include <QWidget>
+
+class AmorAnimation;
+
+
+/**
+ * Plays the base animations of a theme in place, for the dialog.
+ *
+ * The theme is only read once the highlight stays on it for a moment, and
+ * its frames are decoded in a thread of the global pool; the icon of the
+ * theme is shown meanwhile. The frames are then handed to the pixmap
+ * manager of the process, so a theme that is already shown by a creature
+ * is not decoded a second time, and one that is previewed is not decoded
+ * again when it is applied.
+ */
+class AmorPreview : public QWidget
+{
+    Q_OBJECT
+
+    public:
+        explicit AmorPreview(QWidget *parent = 0);
+        ~AmorPreview();
+
+        void setTheme(const QString &path, const QImage &icon = QImage());
+
+        QSize sizeHint() const override;
+
+    protected:
+        void paintEvent(QPaintEvent *event) override;
+        void showEvent(QShowEvent *event) override;
+        void hideEvent(QHideEvent *event) override;
+
+        void setFrames(int generation, const QHash<QString, AmorFrameStore::Frame> &frames);
+
+    protected slots:
+        void slotLoad();
+        void slotTimeout();
+
+    private:
+        QString mPath;              // rc file of the previewed theme
+        QImage mIcon;               // shown until the frames are there
+        int mGeneration;            // of the theme asked for last, to drop late frames
+        AmorThemeManager *mTheme;   // the previewed theme, if it could be read
+        AmorAnimation *mAnim;       // the animation played
+        QTimer mLoadTimer;          // waits for the highlight to settle
+        QTimer mTimer;
+
+        friend class AmorPreviewJob;
+};
+
+
+#endif
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -0,0 +1,314 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amoranimation.h"
+#include "amorengine.h"
+#include "amorthememanager.h"
+#include "amorwindowsystem.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QRandomGenerator>
+
+#include <cstdio>
+
+#define IDLE_TIME 200000    // ms without pointer movement, more than the engine waits before sleeping
+
+// amor-sim runs a creature against a simulated desktop on a virtual clock,
+// without an X server. The same seed always produces the same session, so
+// it can be used to measure the cost of a tick, to look for the creature
+// leaving its window, and to reproduce reported misbehaviour.
+
+class SimWindowSystem : public AmorWindowSystem
+{
+    public:
+        struct Window
+        {
+            QRect geometry;
+            bool minimized;
+            bool maximized;
+        };
+
+        SimWindowSystem() : mActive( 0 ), mWorkArea( 0, 24, 1920, 1056 ) {}
+
+        WId activeWindow() const override { return mActive; }
+        QRect frameGeometry(WId win) const override { return mWindows.value( win ).geometry; }
+        bool isMaximizedVertically(WId win) const override { return mWindows.value( win ).maximized; }
+        bool isMinimized(WId win) const override { return mWindows.value( win ).minimized; }
+        QRect workArea() const override { return mWorkArea; }
+        QPoint cursorPos() const override { return mCursor; }
+
+        WId mActive;
+        QRect mWorkArea;
+        QPoint mCursor;
+        QHash<WId, Window> mWindows;
+};
+
+
+class SimClock : public AmorClock
+{
+    public:
+        SimClock() : mNow( 0 ), mDue( -1 ) {}
+
+        qint64 elapsed() const override { return mNow; }
+        void start(int msec) override { mDue = mNow + msec; }
+        void stop() override { mDue = -1; }
+        bool isActive() const override { return mDue >= 0; }
+
+        qint64 mNow;
+        qint64 mDue;        // when the frame timer fires, -1 if stopped
+};
+
+
+class SimHost : public AmorEngine::Host
+{
+    public:
+        SimHost() : mEngine( 0 ), mFrames( 0 ), mOutside( 0 ) {}
+
+        bool hasBubble() const override { return false; }
+        void dismissBubble() override {}
+        void targetChanged() override {}
+        void targetMoved() override {}
+        void hideCreature() override {}
+        void enteredState() override {}
+
+        void showFrame() override
+        {
+            ++mFrames;
+
+            // Count frames whose hotspot is off the target window.
+            if( mEngine->target() ) {
+                const int position = mEngine->position();
+                if( position < 0 || position > mEngine->targetRect().width() ) {
+                    ++mOutside;
+                }
+            }
+        }
+
+        AmorEngine *mEngine;
+        qint64 mFrames;
+        qint64 mOutside;
+};
+
+
+// Runs the frames due until the current animation ends
+static void finishAnimation(SimClock &clock, AmorEngine &engine)
+{
+    for(int i = 0; i < 10000 && clock.mDue >= 0; ++i) {
+        clock.mNow = qMax( clock.mNow, clock.mDue );
+        clock.mDue = -1;
+        engine.tick();
+        if( !engine.animation()->frameNum() ) {
+            break;
+        }
+    }
+}
+
+
+// The pointer stays still long enough for the creature to get tired, but
+// moves again before the animation that is running ends. The creature
+// must not fall asleep then.
+static int idleWake(SimWindowSystem &windows, SimClock &clock, AmorEngine &engine)
+{
+    engine.windowActivated( windows.mActive );
+    finishAnimation( clock, engine );
+    if( clock.mDue >= 0 ) {
+        clock.mNow = qMax( clock.mNow, clock.mDue );
+        clock.mDue = -1;
+        engine.tick();
+    }
+
+    clock.mNow += IDLE_TIME;
+    engine.pollActivity( true );
+    windows.mCursor += QPoint( 50, 50 );
+    engine.pollActivity( true );
+    finishAnimation( clock, engine );
+
+    const bool asleep = engine.state() == AmorBehaviour::Sleeping;
+    std::printf( "idle-wake: %s\n", asleep ? "asleep after the pointer moved" : "awake" );
+    return asleep ? 2 : 0;
+}
+
+
+// One random thing the user or the window manager does
+static void simulateEvent(SimWindowSystem &windows, AmorEngine &engine, QRandomGenerator &random)
+{
+    const QList<WId> ids = windows.mWindows.keys();
+    const WId win = ids.at( random.bounded( ids.count() ) );
+    SimWindowSystem::Window &window = windows.mWindows[win];
+
+    switch( random.bounded( 6 ) ) {
+    case 0:     // activate a window
+        window.minimized = false;
+        windows.mActive = win;
+        engine.windowActivated( win );
+        break;
+
+    case 1:     // move or resize a window, sometimes above the work area
+        window.geometry = QRect( random.bounded( -200, 1800 ), random.bounded( -50, 1000 ),
+                                 random.bounded( 1, 1920 ), random.bounded( 1, 1080 ) );
+        engine.windowChanged( win, true );
+        break;
+
+    case 2:     // minimize a window
+        window.minimized = true;
+        engine.windowChanged( win, false );
+        break;
+
+    case 3:     // toggle vertical maximization
+        window.maximized = !window.maximized;
+        engine.windowChanged( win, true );
+        break;
+
+    case 4:     // move the pointer
+        windows.mCursor = QPoint( random.bounded( 1920 ), random.bounded( 1080 ) );
+        break;
+
+    default:    // switch desktops
+        windows.mActive = 0;
+        engine.desktopChanged();
+        break;
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app( argc, argv );
+    QCoreApplication::setApplicationName( QStringLiteral( "amor" ) );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( QStringLiteral( "Runs an amor theme headless on a simulated desktop." ) );
+    parser.addHelpOption();
+    parser.addPositionalArgument( QStringLiteral( "theme" ), QStringLiteral( "The theme file, e.g. blobrc." ) );
+    QCommandLineOption seedOption( QStringLiteral( "seed" ), QStringLiteral( "Seed of the session." ), QStringLiteral( "n" ), QStringLiteral( "1" ) );
+    QCommandLineOption ticksOption( QStringLiteral( "ticks" ), QStringLiteral( "Number of frames to run." ), QStringLiteral( "n" ), QStringLiteral( "1000000" ) );
+    QCommandLineOption windowsOption( QStringLiteral( "windows" ), QStringLiteral( "Number of windows." ), QStringLiteral( "n" ), QStringLiteral( "8" ) );
+    QCommandLineOption eventsOption( QStringLiteral( "events" ), QStringLiteral( "Chance in percent of an event every 500 virtual milliseconds." ),
+                                     QStringLiteral( "n" ), QStringLiteral( "10" ) );
+    parser.addOption( seedOption );
+    parser.addOption( ticksOption );
+    parser.addOption( windowsOption );
+    QCommandLineOption scenarioOption( QStringLiteral( "scenario" ), QStringLiteral( "Run a fixed scenario instead of a random session: idle-wake." ),
+                                       QStringLiteral( "name" ) );
+    parser.addOption( eventsOption );
+    parser.addOption( scenarioOption );
+    parser.process( app );
+
+    if( parser.positionalArguments().count() != 1 ) {
+        parser.showHelp( 1 );
+    }
+
+    const quint32 seed = parser.value( seedOption ).toUInt();
+    const qint64 ticks = parser.value( ticksOption ).toLongLong();
+    const int windowCount = qMax( 1, parser.value( windowsOption ).toInt() );
+    const int eventRate = qMax( 0, parser.value( eventsOption ).toInt() );
+
+    AmorThemeManager theme;
+    if( !theme.setTheme( parser.positionalArguments().first() ) ) {
+        std::fprintf( stderr, "Could not read theme %s\n", qPrintable( parser.positionalArguments().first() ) );
+        return 1;
+    }
+
+    const int groups = theme.isStatic() ? 1 : AmorThemeManager::GroupCount;
+    for(int i = 0; i < groups; ++i) {
+        theme.readGroup( static_cast<AmorThemeManager::Group>( i ) );
+    }
+    const AmorBehaviour &behaviour = theme.behaviour();
+    for(int state = AmorBehaviour::BuiltinStateCount; state < behaviour.stateCount() && !theme.isStatic(); ++state) {
+        theme.readGroup( behaviour.group( state ), behaviour.stateName( state ) );
+    }
+
+    // The desktop and the events use their own generator, so that the
+    // session does not change when the engine draws more or fewer numbers.
+    QRandomGenerator random( seed );
+    SimWindowSystem windows;
+    for(int i = 1; i <= windowCount; ++i) {
+        SimWindowSystem::Window window;
+        window.geometry = QRect( random.bounded( 1600 ), random.bounded( 24, 800 ), random.bounded( 100, 1920 ), random.bounded( 100, 1000 ) );
+        window.minimized = false;
+        window.maximized = false;
+        windows.mWindows.insert( i, window );
+    }
+    windows.mActive = 1;
+
+    SimClock clock;
+    SimHost host;
+    AmorEngine engine( &windows, &clock, &host );
+    host.mEngine = &engine;
+    engine.setTheme( &theme );
+    engine.setSeed( seed );
+    engine.start();
+
+    if( parser.isSet( scenarioOption ) ) {
+        if( parser.value( scenarioOption ) == QLatin1String( "idle-wake" ) ) {
+            return idleWake( windows, clock, engine );
+        }
+
+        std::fprintf( stderr, "Unknown scenario %s\n", qPrintable( parser.value( scenarioOption ) ) );
+        return 1;
+    }
+
+    QVector<qint64> stateTicks( behaviour.stateCount() );
+    qint64 nextPoll = 500;
+    qint64 events = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    for(qint64 tick = 0; tick < ticks; ++tick) {
+        // Nothing to do until a window is activated; let time pass.
+        const qint64 due = clock.mDue >= 0 ? clock.mDue : clock.mNow + 100;
+
+        // Deliver the window events and pointer polls due before the next frame.
+        while( nextPoll <= due ) {
+            clock.mNow = nextPoll;
+            if( eventRate && random.bounded( 100 ) < eventRate ) {
+                simulateEvent( windows, engine, random );
+                ++events;
+            }
+            engine.pollActivity( true );
+            nextPoll += 500;
+        }
+
+        if( clock.mDue < 0 ) {
+            clock.mNow = due;
+            continue;
+        }
+
+        clock.mNow = qMax( clock.mNow, clock.mDue );
+        clock.mDue = -1;
+        engine.tick();
+        ++stateTicks[engine.state()];
+    }
+
+    const qint64 elapsed = qMax<qint64>( 1, timer.nsecsElapsed() );
+    std::printf( "seed %u: %lld ticks, %lld frames, %lld events in %lld virtual seconds\n",
+                 seed, ticks, host.mFrames, events, clock.mNow / 1000 );
+    std::printf( "%.0f ticks per second, %.1f ns per tick\n",
+                 ticks * 1e9 / elapsed, double( elapsed ) / qMax<qint64>( 1, ticks ) );
+    std::printf( "frames off the target window: %lld\n", host.mOutside );
+    for(int state = 0; state < behaviour.stateCount(); ++state) {
+        std::printf( "  %-12s %lld\n", qPrintable( behaviour.stateName( state ) ), stateTicks.at( state ) );
+    }
+
+    return host.mOutside ? 2 : 0;
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amorstartupprofile.h"
+#include "amor_debug.h"
+
+#include <QCoreApplication>
+
+#include <cstdio>
+#include <cstring>
+
+AmorStartupProfile *AmorStartupProfile::mProfile = 0;
+
+
+AmorStartupProfile::Scope::Scope(const char *phase)
+  : mPhase( phase ),
+    mStart( 0 ),
+    mNested( 0 ),
+    mParent( 0 )
+{
+    AmorStartupProfile *profile = AmorStartupProfile::profile();
+    if( profile->mActive ) {
+        mStart = profile->mClock.nsecsElapsed();
+        mParent = profile->mCurrent;
+        profile->mCurrent = this;
+    }
+}
+
+
+AmorStartupProfile::Scope::~Scope()
+{
+    AmorStartupProfile *profile = AmorStartupProfile::profile();
+    if( profile->mCurrent != this ) {
+        return;     // entered after the first frame
+    }
+
+    const qint64 elapsed = profile->mClock.nsecsElapsed() - mStart;
+    profile->add( mPhase, elapsed - mNested );
+    if( mParent ) {
+        mParent->mNested += elapsed;
+    }
+    profile->mCurrent = mParent;
+}
+
+
+AmorStartupProfile::AmorStartupProfile()
+  : mCurrent( 0 ),
+    mActive( true ),
+    mReport( false )
+{
+    mClock.start();
+}
+
+
+AmorStartupProfile *AmorStartupProfile::profile()
+{
+    if( !mProfile ) {
+        mProfile = new AmorStartupProfile;
+    }
+
+    return mProfile;
+}
+
+
+void AmorStartupProfile::setReport(bool report)
+{
+    mReport = report;
+}
+
+
+void AmorStartupProfile::add(const char *phase, qint64 nsecs)
+{
+    for(Phase &entry : mPhases) {
+        if( !std::strcmp( entry.name, phase ) ) {
+            entry.nsecs += nsecs;
+            return;
+        }
+    }
+
+    Phase entry;
+    entry.name = phase;
+    entry.nsecs = nsecs;
+    mPhases.append( entry );
+}
+
+
+void AmorStartupProfile::firstFrame()
+{
+    if( !mActive ) {
+        return;
+    }
+
+    mActive = false;
+    const qint64 total = mClock.nsecsElapsed();
+
+    qint64 phases = 0;
+    for(const Phase &phase : qAsConst( mPhases )) {
+        qCDebug(AMOR_LOG) << "Startup phase" << phase.name << phase.nsecs / 1000 << "us";
+        phases += phase.nsecs;
+    }
+    qCDebug(AMOR_LOG) << "First frame after" << total / 1000 << "us";
+
+    if( mReport ) {
+        std::printf( "%-16s %10s\n", "phase", "ms" );
+        for(const Phase &phase : qAsConst( mPhases )) {
+            std::printf( "%-16s %10.3f\n", phase.name, phase.nsecs / 1e6 );
+        }
+        std::printf( "%-16s %10.3f\n", "other", ( total - phases ) / 1e6 );
+        std::printf( "%-16s %10.3f\n", "first frame", total / 1e6 );
+        std::fflush( stdout );
+
+        QCoreApplication::exit( 0 );
+    }
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef AMORSTARTUPPROFILE_H
+#define AMORSTARTUPPROFILE_H
+
+#include <QElapsedTimer>
+#include <QVector>
+
+
+/**
+ * Where the time goes between the start of main() and the first frame.
+ * Scopes add the time spent in them to a named phase, excluding the time
+ * of the scopes nested in them. Recording stops at the first frame.
+ */
+class AmorStartupProfile
+{
+    public:
+        class Scope
+        {
+            public:
+                explicit Scope(const char *phase);
+                ~Scope();
+
+            private:
+                const char *mPhase;
+                qint64 mStart;
+                qint64 mNested;         // time spent in nested scopes
+                Scope *mParent;
+        };
+
+        static AmorStartupProfile *profile();
+
+        void setReport(bool report);    // print the phases and quit at the first frame
+        void firstFrame();
+        bool isActive() const { return mActive; }     // still recording
+
+    protected:
+        AmorStartupProfile();
+        void add(const char *phase, qint64 nsecs);
+
+    private:
+        struct Phase
+        {
+            const char *name;
+            qint64 nsecs;
+        };
+
+        QElapsedTimer mClock;           // monotonic, started in main()
+        QVector<Phase> mPhases;         // in the order they were first entered
+        Scope *mCurrent;
+        bool mActive;
+        bool mReport;
+
+        static AmorStartupProfile *mProfile;
+};
+
+
+#endif
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
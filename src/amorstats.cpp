@@ -0,0 +1,160 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amorstats.h"
+#include "amorallocations.h"
+#include "amorpixmapmanager.h"
+
+#include <QVariantList>
+
+#include <time.h>
+
+#define MISSED_DEADLINE 16      // ms late a tick may run before it counts as missed
+
+AmorStats *AmorStats::mStats = 0;
+
+
+AmorStats::Tick::Tick(int scheduled, qint64 actual)
+  : mCpuStart( cpuTime() ),
+    mXRequests( AmorStats::stats()->mXRequests ),
+    mAllocations( AmorAllocations::count() )
+{
+    AmorStats *stats = AmorStats::stats();
+    const qint64 late = qMax<qint64>( 0, actual - scheduled );
+
+    int bucket = 0;
+    for(qint64 bound = 1; bucket < BucketCount - 1 && late >= bound; bound *= 2) {
+        ++bucket;
+    }
+
+    ++stats->mLateness[bucket];
+    ++stats->mTicks;
+    stats->mScheduled += scheduled;
+    stats->mActual += actual;
+    if( late > MISSED_DEADLINE ) {
+        ++stats->mMissed;
+    }
+}
+
+
+AmorStats::Tick::~Tick()
+{
+    AmorStats *stats = AmorStats::stats();
+
+    const qint64 cpu = cpuTime() - mCpuStart;
+    stats->mCpuTime += cpu;
+    stats->mCpuMax = qMax( stats->mCpuMax, cpu );
+
+    const qint64 requests = stats->mXRequests - mXRequests;
+    stats->mTickXRequests += requests;
+    stats->mTickXMax = qMax( stats->mTickXMax, requests );
+
+    const qint64 allocations = AmorAllocations::count() - mAllocations;
+    stats->mTickAllocations += allocations;
+    stats->mTickAllocationsMax = qMax( stats->mTickAllocationsMax, allocations );
+}
+
+
+AmorStats::AmorStats()
+{
+    reset();
+}
+
+
+AmorStats *AmorStats::stats()
+{
+    if( !mStats ) {
+        mStats = new AmorStats;
+    }
+
+    return mStats;
+}
+
+
+qint64 AmorStats::cpuTime()
+{
+    timespec ts;
+    if( clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts ) != 0 ) {
+        return 0;
+    }
+
+    return qint64( ts.tv_sec ) * 1000000000 + ts.tv_nsec;
+}
+
+
+void AmorStats::reset()
+{
+    for(int i = 0; i < BucketCount; ++i) {
+        mLateness[i] = 0;
+    }
+
+    mTicks = 0;
+    mMissed = 0;
+    mScheduled = 0;
+    mActual = 0;
+    mCpuTime = 0;
+    mCpuMax = 0;
+    mXRequests = 0;
+    mTickXRequests = 0;
+    mTickXMax = 0;
+    mTickAllocations = 0;
+    mTickAllocationsMax = 0;
+}
+
+
+QVariantMap AmorStats::toMap() const
+{
+    QVariantMap map;
+
+    QVariantList bounds;
+    QVariantList lateness;
+    for(int i = 0; i < BucketCount; ++i) {
+        bounds.append( i < BucketCount - 1 ? 1 << i : -1 );
+        lateness.append( mLateness[i] );
+    }
+
+    const qint64 ticks = qMax<qint64>( 1, mTicks );
+    map[QStringLiteral( "ticks" )] = mTicks;
+    map[QStringLiteral( "latenessBoundsMs" )] = bounds;
+    map[QStringLiteral( "latenessHistogram" )] = lateness;
+    map[QStringLiteral( "missedDeadlines" )] = mMissed;
+    map[QStringLiteral( "scheduledIntervalMs" )] = double( mScheduled ) / ticks;
+    map[QStringLiteral( "actualIntervalMs" )] = double( mActual ) / ticks;
+    map[QStringLiteral( "cpuNsPerTick" )] = double( mCpuTime ) / ticks;
+    map[QStringLiteral( "cpuNsMax" )] = mCpuMax;
+    map[QStringLiteral( "xRequests" )] = mXRequests;
+    map[QStringLiteral( "xRequestsPerTick" )] = double( mTickXRequests ) / ticks;
+    map[QStringLiteral( "xRequestsMax" )] = mTickXMax;
+    if( AmorAllocations::isEnabled() ) {
+        map[QStringLiteral( "allocationsPerTick" )] = double( mTickAllocations ) / ticks;
+        map[QStringLiteral( "allocationsMax" )] = mTickAllocationsMax;
+    }
+
+    const AmorPixmapManager *pixmaps = AmorPixmapManager::manager();
+    const qint64 loads = qMax<qint64>( 1, pixmaps->hits() + pixmaps->misses() );
+    map[QStringLiteral( "pixmapFrames" )] = pixmaps->frameCount();
+    map[QStringLiteral( "pixmapDecodedBytes" )] = pixmaps->decodedBytes();
+    map[QStringLiteral( "pixmapMappedBytes" )] = pixmaps->mappedBytes();
+    map[QStringLiteral( "pixmapHits" )] = pixmaps->hits();
+    map[QStringLiteral( "pixmapMisses" )] = pixmaps->misses();
+    map[QStringLiteral( "pixmapHitRate" )] = double( pixmaps->hits() ) / loads;
+
+    return map;
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef AMORSTATS_H
+#define AMORSTATS_H
+
+#include <QVariantMap>
+
+
+/**
+ * Frame pacing and cost statistics of the process, reported over D-Bus
+ * by the org.kde.amor.Stats interface.
+ */
+class AmorStats
+{
+    public:
+        /**
+         * Accounts the CPU time and X requests of one frame tick.
+         */
+        class Tick
+        {
+            public:
+                Tick(int scheduled, qint64 actual);
+                ~Tick();
+
+            private:
+                qint64 mCpuStart;
+                qint64 mXRequests;
+                qint64 mAllocations;
+        };
+
+        static AmorStats *stats();
+
+        // Counted by hand where amor itself causes an X request: moves,
+        // shapes and backing store flushes. Qt's own requests, and those of
+        // other clients on its behalf, are not included.
+        void xRequests(int count = 1) { mXRequests += count; }
+        void reset();
+        QVariantMap toMap() const;
+
+    protected:
+        AmorStats();
+        static qint64 cpuTime();
+
+    private:
+        enum { BucketCount = 8 };
+
+        qint64 mLateness[BucketCount];  // ticks by how late they ran: under 1 ms, 1-2 ms, 2-4 ms, ... 64 ms or more
+        qint64 mTicks;
+        qint64 mMissed;                 // ticks which ran more than a display refresh late
+        qint64 mScheduled;              // sum of the requested frame intervals, ms
+        qint64 mActual;                 // sum of the intervals the frames actually got, ms
+        qint64 mCpuTime;                // thread CPU time spent in ticks, ns
+        qint64 mCpuMax;
+        qint64 mXRequests;              // X requests issued for the creatures
+        qint64 mTickXRequests;          // of which during ticks
+        qint64 mTickXMax;
+        qint64 mTickAllocations;        // heap allocations during ticks, if counted
+        qint64 mTickAllocationsMax;
+
+        static AmorStats *mStats;
+};
+
+
+#endif
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amorframestore.h"
+#include "amorpixmapmanager.h"
+#include "amorthememanager.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QSet>
+#include <QSettings>
+#include <QStandardPaths>
+
+#include <cstdio>
+
+// amor-themec decodes the frames of the given (by default all installed)
+// themes into a frame store, which amor processes map when the FrameStore
+// option points at it. On multi-user hosts this lets all users share one
+// copy of the pixels.
+
+static QStringList installedThemes()
+{
+    QStringList themes;
+    const QStringList dirs = QStandardPaths::standardLocations( QStandardPaths::AppDataLocation );
+    for(const QString &dir : dirs) {
+        const QStringList files = QDir( dir ).entryList( QStringList() << QStringLiteral( "*rc" ), QDir::Files );
+        for(const QString &file : files) {
+            themes.append( dir + QLatin1Char( '/' ) + file );
+        }
+    }
+
+    return themes;
+}
+
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app( argc, argv );
+    QCoreApplication::setApplicationName( QStringLiteral( "amor" ) );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( QStringLiteral( "Builds a frame store shared by all amor processes." ) );
+    parser.addHelpOption();
+    parser.addPositionalArgument( QStringLiteral( "store" ), QStringLiteral( "The frame store to write, e.g. /var/cache/amor/frames." ) );
+    parser.addPositionalArgument( QStringLiteral( "themes" ), QStringLiteral( "Theme files to include, all installed themes by default." ),
+                                  QStringLiteral( "[themes...]" ) );
+    parser.process( app );
+
+    const QStringList args = parser.positionalArguments();
+    if( args.isEmpty() ) {
+        parser.showHelp( 1 );
+    }
+
+    QStringList themes = args.mid( 1 );
+    if( themes.isEmpty() ) {
+        themes = installedThemes();
+    }
+
+    // Collect the frames of all animations, using the same paths as amor.
+    QSet<QString> paths;
+    for(const QString &theme : qAsConst( themes )) {
+        const QString file = QFileInfo::exists( theme ) ? QFileInfo( theme ).absoluteFilePath() : theme;
+
+        AmorThemeManager manager;
+        if( !manager.setTheme( file ) ) {
+            std::fprintf( stderr, "Could not read theme %s\n", qPrintable( theme ) );
+            continue;
+        }
+
+        QSettings config( QFileInfo::exists( file ) ? file : QStandardPaths::locate( QStandardPaths::AppDataLocation, file ),
+                          QSettings::IniFormat );
+        const QStringList groups = config.childGroups();
+        for(const QString &group : groups) {
+            config.beginGroup( group );
+            const QStringList sequence = config.value( "Sequence" ).toStringList();
+            for(const QString &image : sequence) {
+                paths.insert( manager.pixmapPath() + QLatin1Char( '/' ) + image );
+            }
+            config.endGroup();
+        }
+    }
+
+    QList<AmorFrameStore::Frame> frames;
+    for(const QString &path : qAsConst( paths )) {
+        AmorFrameStore::Frame frame;
+        if( AmorPixmapManager::decode( path, &frame ) ) {
+            frames.append( frame );
+        }
+        else {
+            std::fprintf( stderr, "Could not decode %s\n", qPrintable( path ) );
+        }
+    }
+
+    if( !AmorFrameStore::write( args.first(), frames ) ) {
+        std::fprintf( stderr, "Could not write %s\n", qPrintable( args.first() ) );
+        return 1;
+    }
+
+    std::printf( "Wrote %d frames of %d themes to %s\n", frames.count(), themes.count(), qPrintable( args.first() ) );
+    return 0;
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -0,0 +1,376 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amorthemeindex.h"
+#include "amor_debug.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <KConfig>
+#include <KConfigGroup>
+#include <KLocalizedString>
+
+#include <algorithm>
+
+// Index format, all in QDataStream encoding: the magic and a version, the
+// languages of the descriptions, the theme directories with their times of
+// modification and then the themes.
+static const char MAGIC[] = "AMORTHIX";
+static const quint32 VERSION = 2;
+
+#define THUMBNAIL_SIZE 64       // largest side of the icons kept in the index
+#define UPDATE_DELAY 500        // ms to wait for more changes to the theme directories
+#define IMAGE_THREADS 2         // images read at the same time
+
+AmorThemeIndex *AmorThemeIndex::mIndex = 0;
+
+
+static qint64 modificationTime(const QString &path)
+{
+    const QFileInfo info( path );
+    return info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+}
+
+
+static QDataStream &operator<<(QDataStream &stream, const AmorThemeInfo &info)
+{
+    return stream << info.file << info.path << info.pixmapPath << info.description << info.about << info.iconPath << info.icon
+                  << qint32( info.frames ) << info.maximumSize << info.modified << info.pixmapsModified;
+}
+
+
+static QDataStream &operator>>(QDataStream &stream, AmorThemeInfo &info)
+{
+    qint32 frames = 0;
+    stream >> info.file >> info.path >> info.pixmapPath >> info.description >> info.about >> info.iconPath >> info.icon
+           >> frames >> info.maximumSize >> info.modified >> info.pixmapsModified;
+    info.frames = frames;
+    return stream;
+}
+
+
+// Reads the images of one theme in the index's threads
+class AmorThemeImageJob : public QRunnable
+{
+    public:
+        AmorThemeImageJob(AmorThemeIndex *index, const AmorThemeInfo &info)
+          : mIndex( index ),
+            mInfo( info )
+        {
+        }
+
+        void run() override
+        {
+            AmorThemeIndex::readImages( &mInfo );
+
+            AmorThemeIndex *index = mIndex;
+            const AmorThemeInfo info = mInfo;
+            QMetaObject::invokeMethod( index, [index, info]() { index->setImages( info ); }, Qt::QueuedConnection );
+        }
+
+    private:
+        AmorThemeIndex *mIndex;
+        AmorThemeInfo mInfo;
+};
+
+
+AmorThemeIndex::AmorThemeIndex()
+  : mFileName( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) + QLatin1String( "/themes.index" ) )
+{
+    mPool.setMaxThreadCount( IMAGE_THREADS );
+
+    mTimer.setSingleShot( true );
+    mTimer.setInterval( UPDATE_DELAY );
+    connect( &mTimer, SIGNAL(timeout()), SLOT(update()) );
+    connect( &mWatcher, SIGNAL(directoryChanged(QString)), &mTimer, SLOT(start()) );
+    connect( &mWatcher, SIGNAL(fileChanged(QString)), &mTimer, SLOT(start()) );
+
+    load();
+    update();
+}
+
+
+AmorThemeIndex *AmorThemeIndex::index()
+{
+    if( !mIndex ) {
+        mIndex = new AmorThemeIndex;
+    }
+
+    return mIndex;
+}
+
+
+const AmorThemeInfo *AmorThemeIndex::theme(const QString &file) const
+{
+    const int i = find( file );
+    return i >= 0 ? &mThemes.at( i ) : 0;
+}
+
+
+int AmorThemeIndex::find(const QString &file) const
+{
+    const QString name = QFileInfo( file ).fileName();
+    auto it = std::lower_bound( mThemes.cbegin(), mThemes.cend(), name,
+                                [](const AmorThemeInfo &info, const QString &name) { return info.file < name; } );
+    return it != mThemes.cend() && it->file == name ? int( it - mThemes.cbegin() ) : -1;
+}
+
+
+void AmorThemeIndex::update()
+{
+    // The descriptions are translated, so the index only holds for one set of languages.
+    const QString languages = KLocalizedString::languages().join( QLatin1Char( ':' ) );
+    if( languages != mLanguages ) {
+        mThemes.clear();
+        mFolders.clear();
+        mLanguages = languages;
+    }
+
+    const QStringList folders = QStandardPaths::locateAll( QStandardPaths::GenericDataLocation, QStringLiteral( "amor" ),
+                                                           QStandardPaths::LocateDirectory );
+    QHash<QString, qint64> times;
+    for(const QString &folder : folders) {
+        times.insert( folder, modificationTime( folder ) );
+    }
+
+    // No theme was added, removed or renamed if the directories did not
+    // change; then the known themes are all there is to check.
+    QStringList paths;
+    if( times == mFolders ) {
+        for(const AmorThemeInfo &info : qAsConst( mThemes )) {
+            paths.append( info.path );
+        }
+    }
+    else {
+        QSet<QString> names;
+        for(const QString &folder : folders) {
+            const QStringList files = QDir( folder ).entryList( QStringList() << QStringLiteral( "*rc" ), QDir::Files, QDir::Name );
+            for(const QString &file : files) {
+                // The themes of the user hide the system wide ones of the same name.
+                if( !names.contains( file ) ) {
+                    names.insert( file );
+                    paths.append( folder + QLatin1Char( '/' ) + file );
+                }
+            }
+        }
+    }
+
+    bool dirty = times != mFolders;
+    QVector<AmorThemeInfo> themes;
+    themes.reserve( paths.count() );
+    for(const QString &path : qAsConst( paths )) {
+        AmorThemeInfo info = AmorThemeInfo();
+        info.path = path;
+        info.file = QFileInfo( path ).fileName();
+        info.modified = modificationTime( path );
+
+        const AmorThemeInfo *known = theme( info.file );
+        if( known && known->path == path && known->modified == info.modified
+                  && known->pixmapsModified == modificationTime( known->pixmapPath ) ) {
+            themes.append( *known );
+        }
+        else if( readTheme( &info ) ) {
+            themes.append( info );
+            dirty = true;
+        }
+        else {
+            dirty = true;
+        }
+    }
+
+    std::sort( themes.begin(), themes.end(), [](const AmorThemeInfo &a, const AmorThemeInfo &b) { return a.file < b.file; } );
+    mThemes = themes;
+    mFolders = times;
+
+    QStringList watched = folders;
+    for(const AmorThemeInfo &info : qAsConst( mThemes )) {
+        watched << info.path << info.pixmapPath;
+    }
+    watched.removeDuplicates();     // themes may share their pixmaps
+    watch( watched );
+
+    if( dirty ) {
+        save();
+        emit changed();
+    }
+}
+
+
+bool AmorThemeIndex::readTheme(AmorThemeInfo *info)
+{
+    KConfig config( info->path, KConfig::SimpleConfig );
+    KConfigGroup group( &config, "Config" );
+
+    const QString pixmapPath = group.readPathEntry( "PixmapPath", QString() );
+    if( pixmapPath.isEmpty() ) {
+        return false;
+    }
+
+    info->pixmapPath = QDir::isAbsolutePath( pixmapPath ) ? pixmapPath
+                                                          : QFileInfo( info->path ).absolutePath() + QLatin1Char( '/' ) + pixmapPath;
+    info->pixmapsModified = modificationTime( info->pixmapPath );
+    info->description = group.readEntry( "Description" );
+    info->about = group.readEntry( "About", " " );
+    info->iconPath = info->pixmapPath + QLatin1Char( '/' ) + group.readEntry( "Icon" );
+
+    return true;
+}
+
+
+void AmorThemeIndex::readImages(AmorThemeInfo *info)
+{
+    // Decode the icon right at the size of the thumbnail
+    QImageReader reader( info->iconPath );
+    const QSize size = reader.size();
+    if( size.width() > THUMBNAIL_SIZE || size.height() > THUMBNAIL_SIZE ) {
+        reader.setScaledSize( size.scaled( THUMBNAIL_SIZE, THUMBNAIL_SIZE, Qt::KeepAspectRatio ) );
+    }
+    info->icon = reader.read();
+
+    // The frame statistics only need the headers of the images.
+    KConfig config( info->path, KConfig::SimpleConfig );
+    QSet<QString> frames;
+    const QStringList groups = config.groupList();
+    for(const QString &name : groups) {
+        const QStringList sequence = KConfigGroup( &config, name ).readEntry( "Sequence", QStringList() );
+        for(const QString &frame : sequence) {
+            frames.insert( frame );
+        }
+    }
+
+    info->frames = frames.count();
+    info->maximumSize = QSize( 0, 0 );
+    for(const QString &frame : qAsConst( frames )) {
+        info->maximumSize = info->maximumSize.expandedTo( QImageReader( info->pixmapPath + QLatin1Char( '/' ) + frame ).size() );
+    }
+}
+
+
+void AmorThemeIndex::loadImages()
+{
+    for(const AmorThemeInfo &info : qAsConst( mThemes )) {
+        if( !info.maximumSize.isValid() && !mLoading.contains( info.path ) ) {
+            mLoading.insert( info.path );
+            mPool.start( new AmorThemeImageJob( this, info ) );
+        }
+    }
+}
+
+
+void AmorThemeIndex::setImages(const AmorThemeInfo &images)
+{
+    mLoading.remove( images.path );
+
+    // The theme may have changed while its images were read.
+    const int i = find( images.file );
+    if( i >= 0 && mThemes.at( i ).path == images.path && mThemes.at( i ).modified == images.modified ) {
+        AmorThemeInfo &info = mThemes[i];
+        info.icon = images.icon;
+        info.frames = images.frames;
+        info.maximumSize = images.maximumSize;
+        emit imagesLoaded( info.file );
+    }
+
+    if( mLoading.isEmpty() ) {
+        save();
+    }
+}
+
+
+bool AmorThemeIndex::load()
+{
+    QFile file( mFileName );
+    if( !file.open( QIODevice::ReadOnly ) ) {
+        return false;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_12 );
+
+    char magic[8];
+    quint32 version = 0;
+    if( stream.readRawData( magic, 8 ) != 8 || qstrncmp( magic, MAGIC, 8 ) != 0 ) {
+        return false;
+    }
+
+    stream >> version;
+    if( version != VERSION ) {
+        return false;
+    }
+
+    QString languages;
+    QHash<QString, qint64> folders;
+    QVector<AmorThemeInfo> themes;
+    stream >> languages >> folders >> themes;
+    if( stream.status() != QDataStream::Ok ) {
+        qCWarning(AMOR_LOG) << "Ignoring the damaged theme index" << mFileName;
+        return false;
+    }
+
+    mLanguages = languages;
+    mFolders = folders;
+    mThemes = themes;
+    return true;
+}
+
+
+bool AmorThemeIndex::save() const
+{
+    QDir().mkpath( QFileInfo( mFileName ).absolutePath() );
+
+    QSaveFile file( mFileName );
+    if( !file.open( QIODevice::WriteOnly ) ) {
+        qCWarning(AMOR_LOG) << "Could not write the theme index" << mFileName << file.errorString();
+        return false;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_12 );
+    stream.writeRawData( MAGIC, 8 );
+    stream << VERSION << mLanguages << mFolders << mThemes;
+
+    return file.commit();
+}
+
+
+void AmorThemeIndex::watch(const QStringList &paths)
+{
+    QStringList obsolete = mWatcher.directories() + mWatcher.files();
+    QStringList added;
+    for(const QString &path : paths) {
+        if( !obsolete.removeOne( path ) ) {
+            added.append( path );
+        }
+    }
+
+    if( !obsolete.isEmpty() ) {
+        mWatcher.removePaths( obsolete );
+    }
+    if( !added.isEmpty() ) {
+        mWatcher.addPaths( added );
+    }
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef AMORTHEMEINDEX_H
+#define AMORTHEMEINDEX_H
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QSize>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+
+/**
+ * What the dialog and the random theme selection need to know about a
+ * theme, without reading its animations.
+ */
+struct AmorThemeInfo
+{
+    QString file;               // name of the rc file, as stored in the configuration
+    QString path;               // absolute path of the rc file
+    QString pixmapPath;         // directory of the frames
+    QString description;
+    QString about;
+    QString iconPath;
+    QImage icon;                // thumbnail of the theme's icon
+    int frames;                 // different frames used by all animations
+    QSize maximumSize;          // of the largest frame, invalid until the images were read
+    qint64 modified;            // of the rc file, in ms since the epoch
+    qint64 pixmapsModified;     // of the pixmap directory
+};
+
+
+/**
+ * Index of the installed themes, kept in the cache directory.
+ *
+ * Only themes whose rc file or pixmap directory changed since the index
+ * was saved are read again; the others are just checked with a stat().
+ * The theme directories are watched while amor runs, so the index is
+ * also updated when a theme is installed or removed.
+ *
+ * The icons and the frame statistics need the images of a theme, which
+ * may sit on a slow share; they are only read on request by loadImages(),
+ * in threads of their own.
+ */
+class AmorThemeIndex : public QObject
+{
+    Q_OBJECT
+
+    friend class AmorThemeImageJob;
+
+    public:
+        static AmorThemeIndex *index();
+
+        const QVector<AmorThemeInfo> &themes() const { return mThemes; }
+        const AmorThemeInfo *theme(const QString &file) const;
+
+        void loadImages();      // of all themes whose images were not read yet
+
+    signals:
+        void changed();
+        void imagesLoaded(const QString &file);
+
+    public slots:
+        void update();
+
+    protected:
+        AmorThemeIndex();
+
+        bool load();
+        bool save() const;
+        void watch(const QStringList &paths);
+        int find(const QString &file) const;
+        void setImages(const AmorThemeInfo &images);
+
+        static bool readTheme(AmorThemeInfo *info);
+        static void readImages(AmorThemeInfo *info);
+
+    private:
+        QVector<AmorThemeInfo> mThemes;     // sorted by file name, one per name
+        QString mFileName;
+        QString mLanguages;                 // the descriptions were read for
+        QHash<QString, qint64> mFolders;    // the theme directories and their times of modification
+        QFileSystemWatcher mWatcher;
+        QTimer mTimer;                      // collects the changes of a theme installation
+        QThreadPool mPool;                  // reads the images
+        QSet<QString> mLoading;             // rc files whose images are being read
+
+        static AmorThemeIndex *mIndex;
+};
+
+
+#endif
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -18,30 +18,104 @@
  */
 #include "amorthememanager.h"
 #include "amoranimation.h"
-#include "amorpixmapmanager.h"
-
-#include <KRandom>
 
 #include <QFile>
+#include <QSet>
+#include <QRandomGenerator>
 #include <QSettings>
 #include <QStandardPaths>
 
+
+// Builds the alias table of a group (Vose's method), so an animation can be
+// drawn according to its weight with one uniform random column and one coin.
+static void buildAliasTable(AmorAnimationGroup &group)
+{
+    const int count = group.animations.count();
+    group.probability.fill( 1.0, count );
+    group.alias.resize( count );
+
+    qreal total = 0.0;
+    for(const AmorAnimation *anim : qAsConst( group.animations )) {
+        total += anim->weight();
+    }
+    if( total <= 0.0 ) {
+        return;
+    }
+
+    QVector<qreal> scaled( count );
+    QVector<int> small;
+    QVector<int> large;
+    for(int i = 0; i < count; ++i) {
+        group.alias[i] = i;
+        scaled[i] = group.animations.at( i )->weight() * count / total;
+        if( scaled[i] < 1.0 ) {
+            small.append( i );
+        }
+        else {
+            large.append( i );
+        }
+    }
+
+    while( !small.isEmpty() && !large.isEmpty() ) {
+        const int less = small.takeLast();
+        const int more = large.takeLast();
+
+        group.probability[less] = scaled[less];
+        group.alias[less] = more;
+
+        scaled[more] += scaled[less] - 1.0;
+        if( scaled[more] < 1.0 ) {
+            small.append( more );
+        }
+        else {
+            large.append( more );
+        }
+    }
+}
+
 AmorThemeManager::AmorThemeManager()
   : mConfig( 0 ),
-    mMaximumSize(0, 0)
+    mMaximumSize(0, 0),
+    mGroups( GroupCount ),
+    mStatic( false )
 {
 }
 
 
 AmorThemeManager::~AmorThemeManager()
 {
-    for( const AmorAnimationGroup &group : mAnimations ) {
-        qDeleteAll( group );
-    }
+    clear();
     delete mConfig;
 }
 
 
+void AmorThemeManager::clear()
+{
+    for(AmorAnimationGroup &group : mGroups) {
+        qDeleteAll( group.animations );
+    }
+    mGroups.fill( AmorAnimationGroup(), GroupCount );
+}
+
+
+QString AmorThemeManager::groupName(Group group)
+{
+    static const char *const names[GroupCount] = { "Base", "Sequences", "Focus", "Blur", "Destroy", "Sleep", "Wake" };
+    return QLatin1String( names[group] );
+}
+
+
+void AmorThemeManager::swap(AmorThemeManager &other)
+{
+    qSwap( mPath, other.mPath );
+    qSwap( mConfig, other.mConfig );
+    qSwap( mMaximumSize, other.mMaximumSize );
+    mGroups.swap( other.mGroups );
+    qSwap( mBehaviour, other.mBehaviour );
+    qSwap( mStatic, other.mStatic );
+}
+
+
 bool AmorThemeManager::setTheme(const QString & file)
 {
     if (QFile::exists(file)) {
@@ -77,46 +151,59 @@ bool AmorThemeManager::setTheme(const QString & file)
     mMaximumSize.setWidth( 0 );
     mMaximumSize.setHeight( 0 );
 
-    for( const AmorAnimationGroup &group : mAnimations ) {
-        qDeleteAll( group );
-    }
-    mAnimations.clear();
+    clear();
     mConfig->endGroup();
 
+    // States beyond the built-in ones play groups numbered after the standard ones
+    mBehaviour = AmorBehaviour();
+    mBehaviour.read( mConfig, GroupCount );
+
     return true;
 }
 
 
-AmorAnimation *AmorThemeManager::random(const QString & group)
+AmorAnimation *AmorThemeManager::random(int group, QRandomGenerator *generator) const
 {
-    QString grp = mStatic ? QLatin1String( "Base" ) : group;
+    if( mStatic || group >= mGroups.size() ) {
+        group = BaseGroup;
+    }
 
-    const QHash<QString, AmorAnimationGroup>::const_iterator it = mAnimations.constFind( grp );
+    const AmorAnimationGroup &animations = mGroups.at( group );
+    const int count = animations.animations.count();
 
-    if( it != mAnimations.constEnd() ) {
-        int idx = KRandom::random() % it->count();
-        return it->at( idx );
+    if( !count ) {
+        return 0;
     }
 
-    return 0;
+    const int column = generator->bounded( count );
+    if( generator->generateDouble() < animations.probability.at( column ) ) {
+        return animations.animations.at( column );
+    }
+
+    return animations.animations.at( animations.alias.at( column ) );
 }
 
 
-bool AmorThemeManager::readGroup(const QString & seq)
+bool AmorThemeManager::readGroup(Group group)
+{
+    return readGroup( group, groupName( group ) );
+}
+
+
+bool AmorThemeManager::readGroup(int group, const QString &name)
 {
-    AmorPixmapManager::manager()->setPixmapDir( mPath );
     AmorAnimationGroup animList;
 
     // Read the list of available animations.
     mConfig->beginGroup("Config");
-    QStringList list = mConfig->value(seq).toStringList();
+    QStringList list = mConfig->value( name ).toStringList();
     mConfig->endGroup();
 
     // Read each individual animation
     for(int i = 0; i < list.count(); ++i) {
         mConfig->beginGroup(list[i]);
-        AmorAnimation *anim = new AmorAnimation( mConfig );
-        animList.append( anim );
+        AmorAnimation *anim = new AmorAnimation( mConfig, mPath );
+        animList.animations.append( anim );
         mMaximumSize = mMaximumSize.expandedTo( anim->maximumSize() );
         mConfig->endGroup();
     }
@@ -124,9 +211,9 @@ bool AmorThemeManager::readGroup(const QString & seq)
     int entries = list.count();
     if ( entries == 0) {    // If no animations were available for this group, just add the base anim
         mConfig->beginGroup("Base");
-        AmorAnimation *anim = new AmorAnimation( mConfig);
+        AmorAnimation *anim = new AmorAnimation( mConfig, mPath );
         if( anim ) {
-            animList.append( anim );
+            animList.animations.append( anim );
             mMaximumSize = mMaximumSize.expandedTo( anim->maximumSize() );
             ++entries;
         }
@@ -138,7 +225,14 @@ bool AmorThemeManager::readGroup(const QString & seq)
         return false;
     }
 
-    mAnimations[seq] = animList;
+    buildAliasTable( animList );
+
+    if( group >= mGroups.size() ) {
+        mGroups.resize( group + 1 );
+    }
+
+    qDeleteAll( mGroups[group].animations );
+    mGroups[group] = animList;
 
     return true;
 }
@@ -150,11 +244,36 @@ bool AmorThemeManager::isStatic() const
 }
 
 
+QString AmorThemeManager::pixmapPath() const
+{
+    return mPath;
+}
+
+
 QSize AmorThemeManager::maximumSize() const
 {
     return mMaximumSize;
 }
 
 
+QVector<const QImage*> AmorThemeManager::frames() const
+{
+    QSet<const QImage*> seen;
+    QVector<const QImage*> frames;
+    for(const AmorAnimationGroup &group : mGroups) {
+        for(const AmorAnimation *anim : group.animations) {
+            for(const QImage *frame : anim->frames()) {
+                if( frame && !seen.contains( frame ) ) {
+                    seen.insert( frame );
+                    frames.append( frame );
+                }
+            }
+        }
+    }
+
+    return frames;
+}
+
+
 // kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
 // vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
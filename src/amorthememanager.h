@@ -19,34 +19,64 @@
 #ifndef AMORTHEMEMANAGER_H
 #define AMORTHEMEMANAGER_H
 
-#include <QHash>
+#include <QList>
+#include <QRandomGenerator>
 #include <QSize>
 #include <QSettings>
+#include <QVector>
+
+#include "amorbehaviour.h"
 
 class KConfig;
+class QImage;
 class AmorAnimation;
-typedef QList<AmorAnimation*> AmorAnimationGroup;
+
+
+/**
+ * The animations of one group, with an alias table to pick one of them at
+ * random according to their weights in constant time.
+ */
+struct AmorAnimationGroup
+{
+    QList<AmorAnimation*> animations;
+    QVector<qreal> probability;     // chance to keep the column that was drawn
+    QVector<int> alias;             // the animation to use otherwise
+};
 
 
 class AmorThemeManager
 {
     public:
+        // Standard animation groups
+        enum Group { BaseGroup, NormalGroup, FocusGroup, BlurGroup, DestroyGroup, SleepGroup, WakeGroup, GroupCount };
+
         AmorThemeManager();
         virtual ~AmorThemeManager();
 
         bool setTheme(const QString &file);
-        bool readGroup(const QString &seq);
+        void swap(AmorThemeManager &other);     // exchange the themes read, e.g. once a new one is complete
+        bool readGroup(Group group);
+        bool readGroup(int group, const QString &name);
         bool isStatic() const;
+        QString pixmapPath() const;
 
-        AmorAnimation *random(const QString &group);
+        AmorAnimation *random(int group, QRandomGenerator *generator = QRandomGenerator::global()) const;
+        const AmorBehaviour &behaviour() const { return mBehaviour; }
 
         QSize maximumSize() const;
+        QVector<const QImage*> frames() const;  // the frames of all groups read, each once
+
+        static QString groupName(Group group);
+
+    protected:
+        void clear();
 
     protected:
         QString mPath;
         QSettings *mConfig;
         QSize mMaximumSize;                              // The largest pixmap used
-        QHash<QString, AmorAnimationGroup> mAnimations;  // list of animation groups
+        QVector<AmorAnimationGroup> mGroups;             // the standard groups followed by those of the behaviour
+        AmorBehaviour mBehaviour;                        // states and transitions of the theme
         bool mStatic;	                                 // static image
 };
 
@@ -18,83 +18,173 @@
 #include "amortips.h"
 #include "amor_debug.h"
 
-#include <QFile>
-#include <QRegExp>
+#include <QRandomGenerator>
 #include <QStandardPaths>
 
-#include <stdlib.h>
+#include <string.h>
 
 #include <KLocalizedString>
-#include <KRandom>
 
 
 
+#define TIPS_FILE "tips-en"   // the English tips, also the message ids of their translations
+
+
 AmorTips::AmorTips()
+  : mData(0),
+    mSize(0),
+    mTranslate(true)
+{
+}
+
+AmorTips::~AmorTips()
 {
+    reset();
 }
 
 bool AmorTips::setFile(const QString& file)
 {
     QString path(QStandardPaths::locate(QStandardPaths::AppDataLocation, file));
     if (path.isEmpty()) {
-        qDebug() << "File not found in share/amor:" << file;
+        qCDebug(AMOR_LOG) << "File not found in share/amor:" << file;
         return false;
     }
     return read(path);
 }
 
-void AmorTips::reset()
+bool AmorTips::setLanguages(const QStringList &languages)
 {
-    mTips.clear();
+    const bool changed = languages != mLanguages;
+    mLanguages = languages;
+
+    for (const QString &language : languages) {
+        if (language == QLatin1String("en") || language.startsWith(QLatin1String("en_"))) {
+            break;
+        }
+
+        if (mLanguage == language && mData) {
+            return true;    // already mapped
+        }
+
+        const QString bundle = QStandardPaths::locate(QStandardPaths::AppDataLocation, QLatin1String("tips-") + language);
+        if (!bundle.isEmpty() && read(bundle)) {
+            mLanguage = language;
+            mTranslate = false;
+            return true;
+        }
+    }
+
+    // No bundle: translate the English tips at runtime, if at all.
+    if (mLanguage.isEmpty() && mData) {
+        if (changed) {
+            mTranslated.clear();    // translated into the previous language
+        }
+        return true;
+    }
+
+    const bool found = setFile(QLatin1String(TIPS_FILE));
+    mLanguage.clear();
+    mTranslate = true;
+    return found;
 }
 
-QString AmorTips::tip()
+void AmorTips::reset()
 {
-    if (mTips.count()) {
-        QString tip = mTips.at( KRandom::random() % mTips.count() );
-        return i18n( tip.toUtf8() );
+    mIndex.clear();
+    mTranslated.clear();
+    mBuffer.clear();
+    mData = 0;
+    mSize = 0;
+    mLanguage.clear();
+    mTranslate = true;
+    if (mFile.isOpen()) {
+        mFile.close();      // also unmaps the file
     }
-    return QString();
 }
 
-bool AmorTips::read(const QString& path)
+QString AmorTips::tip()
 {
-    QFile file( path );
+    if (mIndex.isEmpty()) {
+        return QString();
+    }
 
-    if( file.open( QIODevice::ReadOnly ) ) {
-        while( !file.atEnd() ) {
-            readTip( file );
-        }
+    const int index = QRandomGenerator::global()->bounded(mIndex.size());
+    QHash<int, QString>::const_iterator it = mTranslated.constFind(index);
+    if (it != mTranslated.constEnd()) {
+        return *it;
+    }
 
-        qDebug() << "read" << mTips.count() << "tips";
-        return true;
+    // The untranslated tip is its own message id.
+    const QString tip = mTranslate ? i18n(text(index).constData()) : QString::fromUtf8(text(index));
+    mTranslated.insert(index, tip);
+    return tip;
+}
+
+qint64 AmorTips::memoryUsage() const
+{
+    qint64 bytes = mIndex.capacity() * sizeof(Span) + mBuffer.capacity();
+    for (QHash<int, QString>::const_iterator it = mTranslated.constBegin(); it != mTranslated.constEnd(); ++it) {
+        bytes += sizeof(QString) + it->capacity() * sizeof(QChar);
     }
+    return bytes;
+}
 
-    return false;
+QByteArray AmorTips::text(int index) const
+{
+    const Span &span = mIndex.at(index);
+    return QByteArray(mData + span.offset, span.length);
 }
 
 
-bool AmorTips::readTip(QFile &file)
+bool AmorTips::read(const QString& path)
 {
-    char buffer[1024] = "";
-    QString tip;
+    reset();
 
-    while( !file.atEnd() && buffer[0] != '%' ) {
-        file.readLine( buffer, 1024 );
-        if( buffer[0] != '%' ) {
-            tip += QString::fromUtf8( buffer );
-        }
+    mFile.setFileName(path);
+    if (!mFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    mSize = mFile.size();
+    mData = reinterpret_cast<const char *>(mFile.map(0, mSize));
+    if (!mData) {
+        mBuffer = mFile.readAll();
+        mFile.close();
+        mData = mBuffer.constData();
+        mSize = mBuffer.size();
     }
 
-    if (!tip.isEmpty()) {
-        if (tip.endsWith(QLatin1Char('\n'))) {
-            tip.chop(1);
+    // Index the tips; lines starting with '%' separate them. Tips can be
+    // of any length.
+    qint64 start = 0;
+    qint64 line = 0;
+    while (line <= mSize) {
+        if (line == mSize || mData[line] == '%') {
+            qint64 length = line - start;
+            if (length > 0 && mData[start + length - 1] == '\n') {
+                --length;
+            }
+            if (length > 0) {
+                const Span span = { quint32(start), quint32(length) };
+                mIndex.append(span);
+            }
         }
-        mTips.append(tip);
-        return true;
+
+        if (line == mSize) {
+            break;
+        }
+
+        const char *newline = static_cast<const char *>(memchr(mData + line, '\n', mSize - line));
+        const qint64 next = newline ? newline - mData + 1 : mSize;
+        if (mData[line] == '%') {
+            start = next;
+        }
+        line = next;
     }
 
-    return false;
+    mIndex.squeeze();
+    qCDebug(AMOR_LOG) << "read" << mIndex.count() << "tips";
+    return true;
 }
 
 
@@ -18,27 +18,60 @@
 #ifndef AMORTIPS_H
 #define AMORTIPS_H
 
+#include <QFile>
+#include <QHash>
+#include <QString>
 #include <QStringList>
-
-class QFile;
+#include <QVector>
 
 
+/**
+ * The tips shown in the bubble, read from a file of tips separated by
+ * lines starting with '%'.
+ *
+ * The file is memory mapped and only an index of where each tip starts
+ * is built when it is read, so tips cost nothing until they are shown.
+ * The chosen tip is decoded and translated then, and the translation is
+ * kept for the next time it comes up.
+ *
+ * Languages with a tips bundle built from their catalog (tips-<language>)
+ * use it as it is; otherwise the English tips are translated with i18n().
+ */
 class AmorTips
 {
     public:
         AmorTips();
+        ~AmorTips();
 
         bool setFile(const QString& file);
+        bool setLanguages(const QStringList &languages);
+        QString language() const { return mLanguage; }
         void reset();
         QString tip();
 
+        int count() const { return mIndex.size(); }
+        qint64 memoryUsage() const;     // bytes held for the tips
+
     protected:
-        bool readKTips();
         bool read(const QString& file);
-        bool readTip(QFile &file);
+        QByteArray text(int index) const;
 
     protected:
-        QStringList mTips;
+        struct Span
+        {
+            quint32 offset;     // of the first line of the tip
+            quint32 length;     // without the final newline
+        };
+
+        QFile mFile;
+        QByteArray mBuffer;             // the file, if it could not be mapped
+        const char *mData;              // the contents of the file
+        qint64 mSize;
+        QVector<Span> mIndex;           // where each tip is in the file
+        QHash<int, QString> mTranslated; // tips shown so far, translated
+        QString mLanguage;              // of the bundle, empty for the English tips
+        QStringList mLanguages;         // asked for by setLanguages()
+        bool mTranslate;                // the tips are English, to be translated with i18n()
 };
 
 
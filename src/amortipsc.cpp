@@ -0,0 +1,206 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <QStringList>
+
+#include <cstdio>
+
+// amor-tipsc builds the tips bundle of one language at build time: the
+// English tips file with each tip replaced by its translation from the
+// language's catalog. The tips reach the catalog through preparetips, so
+// the message id of a tip is its text without the final newline. Tips
+// without a translation are kept in English.
+
+// Splits a tips file at the lines starting with '%'
+static QList<QByteArray> readTips(const QByteArray &data)
+{
+    QList<QByteArray> tips;
+    QByteArray tip;
+    for(const QByteArray &line : data.split( '\n' )) {
+        if( line.startsWith( '%' ) ) {
+            if( !tip.isEmpty() ) {
+                tip.chop( 1 );
+                tips.append( tip );
+            }
+            tip.clear();
+        }
+        else {
+            tip += line + '\n';
+        }
+    }
+
+    // The file ends with a newline, which split() turned into an empty line.
+    if( tip.endsWith( "\n\n" ) ) {
+        tip.chop( 1 );
+    }
+    if( tip.size() > 1 ) {
+        tip.chop( 1 );
+        tips.append( tip );
+    }
+
+    return tips;
+}
+
+
+// Undoes the escapes of a quoted catalog string
+static QByteArray unquote(const QByteArray &line)
+{
+    const int begin = line.indexOf( '"' );
+    const int end = line.lastIndexOf( '"' );
+    QByteArray text;
+    for(int i = begin + 1; i < end; ++i) {
+        char c = line.at( i );
+        if( c == '\\' && i + 1 < end ) {
+            c = line.at( ++i );
+            switch( c ) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                default: break;     // \" and \\ stand for themselves
+            }
+        }
+        text += c;
+    }
+
+    return text;
+}
+
+
+// The translations of a catalog by message id, leaving out the fuzzy ones
+static QHash<QByteArray, QByteArray> readCatalog(QFile &file)
+{
+    QHash<QByteArray, QByteArray> translations;
+    QByteArray context;
+    QByteArray id;
+    QByteArray str;
+    QByteArray *current = 0;
+    bool fuzzy = false;
+
+    auto finish = [&]() {
+        if( !id.isEmpty() && !str.isEmpty() && !fuzzy && context.isEmpty() ) {
+            translations.insert( id, str );
+        }
+        context.clear();
+        id.clear();
+        str.clear();
+        current = 0;
+        fuzzy = false;
+    };
+
+    while( !file.atEnd() ) {
+        const QByteArray line = file.readLine().trimmed();
+        if( line.startsWith( "#," ) ) {
+            if( current == &str ) {
+                finish();
+            }
+            fuzzy = line.contains( "fuzzy" );
+        }
+        else if( line.startsWith( '#' ) || line.isEmpty() ) {
+            if( current == &str ) {
+                finish();
+            }
+        }
+        else if( line.startsWith( "msgctxt " ) ) {
+            if( current == &str ) {
+                finish();
+            }
+            context = unquote( line );
+            current = &context;
+        }
+        else if( line.startsWith( "msgid " ) ) {
+            if( current == &str ) {
+                finish();
+            }
+            id = unquote( line );
+            current = &id;
+        }
+        else if( line.startsWith( "msgstr " ) ) {
+            str = unquote( line );
+            current = &str;
+        }
+        else if( line.startsWith( "msgid_plural " ) || line.startsWith( "msgstr[" ) ) {
+            current = 0;    // plural forms are not used by tips
+        }
+        else if( line.startsWith( '"' ) && current ) {
+            *current += unquote( line );
+        }
+    }
+    finish();
+
+    return translations;
+}
+
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app( argc, argv );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( QStringLiteral( "Builds the tips bundle of a language from its catalog." ) );
+    parser.addHelpOption();
+    parser.addPositionalArgument( QStringLiteral( "tips" ), QStringLiteral( "The English tips file, tips-en." ) );
+    parser.addPositionalArgument( QStringLiteral( "catalog" ), QStringLiteral( "The amor.po catalog of the language." ) );
+    parser.addPositionalArgument( QStringLiteral( "bundle" ), QStringLiteral( "The tips bundle to write, e.g. tips-de." ) );
+    parser.process( app );
+
+    const QStringList args = parser.positionalArguments();
+    if( args.count() != 3 ) {
+        parser.showHelp( 1 );
+    }
+
+    QFile tipsFile( args.at( 0 ) );
+    QFile catalogFile( args.at( 1 ) );
+    if( !tipsFile.open( QIODevice::ReadOnly ) || !catalogFile.open( QIODevice::ReadOnly ) ) {
+        std::fprintf( stderr, "Could not read %s\n", qPrintable( tipsFile.isOpen() ? args.at( 1 ) : args.at( 0 ) ) );
+        return 1;
+    }
+
+    const QList<QByteArray> tips = readTips( tipsFile.readAll() );
+    const QHash<QByteArray, QByteArray> translations = readCatalog( catalogFile );
+
+    QByteArray bundle;
+    int translated = 0;
+    for(const QByteArray &tip : tips) {
+        QByteArray text = translations.value( tip );
+        if( text.isEmpty() ) {
+            text = tip;
+        }
+        else {
+            ++translated;
+        }
+
+        // A line starting with '%' would end the tip early.
+        text.replace( "\n%", "\n %" );
+        bundle += text + "\n%\n";
+    }
+
+    QSaveFile out( args.at( 2 ) );
+    if( !out.open( QIODevice::WriteOnly ) || out.write( bundle ) != bundle.size() || !out.commit() ) {
+        std::fprintf( stderr, "Could not write %s\n", qPrintable( args.at( 2 ) ) );
+        return 1;
+    }
+
+    std::printf( "Translated %d of %d tips into %s\n", translated, tips.count(), qPrintable( args.at( 2 ) ) );
+    return 0;
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "amortrace.h"
+#include "amor_debug.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+
+// The trace is a JSON array of events written as they happen. Viewers
+// accept an array without the closing bracket, so a trace stays usable
+// when amor does not exit cleanly.
+
+static QFile *sFile = 0;
+static QElapsedTimer sClock;
+static qint64 sPid = 0;
+static bool sFirst = true;
+
+
+static void writeEvent(const char *name, char phase, qint64 start, qint64 duration)
+{
+    QByteArray event;
+    event.reserve( 128 );
+    event += sFirst ? "\n" : ",\n";
+    event += "{\"name\":\"";
+    event += name;
+    event += "\",\"cat\":\"amor\",\"ph\":\"";
+    event += phase;
+    event += "\",\"ts\":";
+    event += QByteArray::number( start / 1000.0, 'f', 3 );
+    if( phase == 'X' ) {
+        event += ",\"dur\":";
+        event += QByteArray::number( duration / 1000.0, 'f', 3 );
+    }
+    else {
+        event += ",\"s\":\"t\"";
+    }
+    event += ",\"pid\":";
+    event += QByteArray::number( sPid );
+    event += ",\"tid\":1}";
+
+    sFile->write( event );
+    sFirst = false;
+}
+
+
+AmorTrace::Scope::Scope(const char *name)
+  : mName( name ),
+    mStart( sFile ? sClock.nsecsElapsed() : 0 )
+{
+}
+
+
+AmorTrace::Scope::~Scope()
+{
+    if( sFile ) {
+        writeEvent( mName, 'X', mStart, sClock.nsecsElapsed() - mStart );
+    }
+}
+
+
+bool AmorTrace::open(const QString &fileName)
+{
+    close();
+
+    sFile = new QFile( fileName );
+    if( !sFile->open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        qCWarning(AMOR_LOG) << "Could not open trace file" << fileName << sFile->errorString();
+        delete sFile;
+        sFile = 0;
+        return false;
+    }
+
+    sPid = QCoreApplication::applicationPid();
+    sFirst = true;
+    sFile->write( "[" );
+    sClock.start();
+
+    return true;
+}
+
+
+void AmorTrace::close()
+{
+    if( sFile ) {
+        sFile->write( "\n]\n" );
+        delete sFile;
+        sFile = 0;
+    }
+}
+
+
+bool AmorTrace::isOpen()
+{
+    return sFile != 0;
+}
+
+
+void AmorTrace::instant(const char *name)
+{
+    if( sFile ) {
+        writeEvent( name, 'i', sClock.nsecsElapsed(), 0 );
+    }
+}
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef AMORTRACE_H
+#define AMORTRACE_H
+
+#include <QString>
+
+
+/**
+ * Writes trace events in the Chrome Trace Event JSON format, which
+ * chrome://tracing and the Perfetto UI open. The trace points are only
+ * compiled in when building with AMOR_TRACING, and cost a branch unless
+ * a trace file is open.
+ */
+class AmorTrace
+{
+    public:
+        class Scope
+        {
+            public:
+                explicit Scope(const char *name);
+                ~Scope();
+
+            private:
+                const char *mName;
+                qint64 mStart;
+        };
+
+        static bool open(const QString &fileName);
+        static void close();
+        static bool isOpen();
+
+        static void instant(const char *name);
+};
+
+
+#ifdef AMOR_TRACING
+#define AMOR_TRACE_CONCAT2(a, b) a##b
+#define AMOR_TRACE_CONCAT(a, b) AMOR_TRACE_CONCAT2(a, b)
+#define AMOR_TRACE_SCOPE(name) AmorTrace::Scope AMOR_TRACE_CONCAT(amorTraceScope, __LINE__)( name )
+#define AMOR_TRACE_INSTANT(name) AmorTrace::instant( name )
+#else
+#define AMOR_TRACE_SCOPE(name) do {} while( false )
+#define AMOR_TRACE_INSTANT(name) do {} while( false )
+#endif
+
+
+#endif
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -16,46 +16,129 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 #include "amorwidget.h"
+#include "amoranimation.h"
+#include "amoroverlay.h"
+#include "amorpixmapmanager.h"
+#include "amorstats.h"
+#include "amortrace.h"
 
-#include <QBitmap>
+#include <QImage>
 #include <QPainter>
 #include <QMouseEvent>
 #include <QApplication>
 
 #include <QDebug>
 
-AmorWidget::AmorWidget()
-  : QWidget( 0, Qt::X11BypassWindowManagerHint | Qt::WindowStaysOnTopHint ),
-    m_pixmap( 0 ),
+AmorWidget::AmorWidget(bool overlay)
+  : QWidget( overlay ? AmorOverlay::overlay( QGuiApplication::primaryScreen() ) : 0,
+             overlay ? Qt::WindowFlags() : Qt::X11BypassWindowManagerHint | Qt::WindowStaysOnTopHint ),
+    m_frame( 0 ),
     m_dragging( false )
 {
+    if( overlay ) {
+        setAttribute( Qt::WA_TransparentForMouseEvents );
+    }
+}
+
+
+void AmorWidget::setGlobalGeometry(const QRect &rect)
+{
+    if( !isOverlay() ) {
+        if( rect != geometry() ) {
+            setGeometry( rect );
+            AmorStats::stats()->xRequests();
+        }
+        return;
+    }
+
+    // Draw into the overlay of the screen the frame is on.
+    AmorOverlay *overlay = AmorOverlay::overlayAt( rect.center() );
+    if( overlay != parentWidget() ) {
+        const bool hidden = isHidden();
+        setParent( overlay );
+        setHidden( hidden );
+    }
+
+    setGeometry( rect.translated( -overlay->geometry().topLeft() ) );
+}
+
+
+void AmorWidget::showAnimation(const AmorAnimation *anim, const QPoint &pos)
+{
+    // The widget is sized to the current (trimmed) frame, so it only ever
+    // covers the pixels which are actually visible.
+    const QImage *frame = anim->frame();
+    const QRect damage = anim->damage( m_frame );
+    if( frame ) {
+        setGlobalGeometry( QRect( pos, frame->size() ) );
+    }
+    else {
+        moveGlobal( pos );
+    }
+    setFrame( frame, damage );
+}
+
+
+bool AmorWidget::event(QEvent *event)
+{
+    // A window of its own flushes its backing store with one image upload;
+    // in overlay mode the overlay flushes for all its widgets.
+    if( event->type() == QEvent::UpdateRequest && !isOverlay() ) {
+        AmorStats::stats()->xRequests();
+    }
+
+    return QWidget::event( event );
+}
+
+
+void AmorWidget::changeEvent(QEvent *event)
+{
+    if( event->type() == QEvent::LanguageChange || event->type() == QEvent::LocaleChange ) {
+        emit languageChanged();
+    }
+
+    QWidget::changeEvent( event );
+}
+
+
+QRect AmorWidget::globalGeometry() const
+{
+    return QRect( mapToGlobal( QPoint( 0, 0 ) ), size() );
 }
 
 
 #include <iostream>
 
-void AmorWidget::setPixmap(const QPixmap *pixmap)
+void AmorWidget::setFrame(const QImage *frame, const QRect &damage)
 {
-    m_pixmap = pixmap;
-
-    if ( pixmap ) {
-        const auto dpr = qApp->devicePixelRatio();
-        const auto mask = m_pixmap->scaled(m_pixmap->width() * dpr, m_pixmap->height() * dpr,
-                                           Qt::KeepAspectRatio, Qt::FastTransformation).mask();
-        if (!mask.isNull()) {
-            setMask(mask);
-            repaint();
+    AMOR_TRACE_SCOPE( "AmorWidget::setFrame" );
+
+    m_frame = frame;
+
+    // Nothing to do if the new frame looks exactly like the one on screen.
+    if ( frame && !damage.isEmpty() ) {
+        // The overlay is translucent, so only a top level widget needs a shape.
+        if ( !isOverlay() ) {
+            // Frames of an animation often share their outline; setting the
+            // same shape again would cost an X request and an allocation.
+            const QRegion mask = AmorPixmapManager::manager()->mask( frame );
+            if ( !mask.isEmpty() && mask != this->mask() ) {
+                setMask( mask );
+                AmorStats::stats()->xRequests();
+            }
         }
-        update();
+        update( damage );
     }
 }
 
 
 void AmorWidget::paintEvent(QPaintEvent *)
 {
-    if( m_pixmap ) {
+    AMOR_TRACE_SCOPE( "AmorWidget::paintEvent" );
+
+    if( m_frame ) {
         QPainter p( this );
-        p.drawPixmap( 0, 0, *m_pixmap);
+        p.drawImage( 0, 0, *m_frame );
     }
 }
 
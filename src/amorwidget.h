@@ -20,7 +20,8 @@
 
 #include <QWidget>
 
-class QPixmap;
+class AmorAnimation;
+class QImage;
 
 
 class AmorWidget : public QWidget
@@ -28,22 +29,33 @@ class AmorWidget : public QWidget
     Q_OBJECT
 
     public:
-        AmorWidget();
+        explicit AmorWidget(bool overlay = false);
 
-        void setPixmap(const QPixmap *pixmap);
+        void setFrame(const QImage *frame, const QRect &damage = QRect());
+        const QImage *frame() const { return m_frame; }
+        void showAnimation(const AmorAnimation *anim, const QPoint &pos);
+
+        void setGlobalGeometry(const QRect &rect);
+        void moveGlobal(const QPoint &pos) { setGlobalGeometry( QRect( pos, size() ) ); }
+        QRect globalGeometry() const;
+
+        bool isOverlay() const { return !isWindow(); }
 
     signals:
         void mouseClicked(const QPoint &pos);
         void dragged(const QPoint &delta, bool release);
+        void languageChanged();     // or the locale
 
     protected:
+        bool event(QEvent *event) override;
+        void changeEvent(QEvent *event) override;
         void paintEvent(QPaintEvent *event);
         void mousePressEvent(QMouseEvent *event);
         void mouseMoveEvent(QMouseEvent *event);
         void mouseReleaseEvent(QMouseEvent *event);
 
     protected:
-        const QPixmap *m_pixmap;
+        const QImage *m_frame;
         QPoint m_clickPos;
         bool m_dragging;
 };
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2026 by the Amor authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef AMORWINDOWSYSTEM_H
+#define AMORWINDOWSYSTEM_H
+
+#include <QPoint>
+#include <QRect>
+#include <qwindowdefs.h>
+
+
+/**
+ * The queries the creature makes about the windows it sits on. Amor
+ * answers them from KWindowSystem, the simulator from a model of a desktop.
+ */
+class AmorWindowSystem
+{
+    public:
+        virtual ~AmorWindowSystem() {}
+
+        virtual WId activeWindow() const = 0;
+        virtual QRect frameGeometry(WId win) const = 0;
+        virtual bool isMaximizedVertically(WId win) const = 0;
+        virtual bool isMinimized(WId win) const = 0;        // iconified or withdrawn
+        virtual QRect workArea() const = 0;                 // of the current desktop
+        virtual QPoint cursorPos() const = 0;
+};
+
+
+/**
+ * The time source and single shot frame timer of a creature.
+ */
+class AmorClock
+{
+    public:
+        virtual ~AmorClock() {}
+
+        virtual qint64 elapsed() const = 0;                 // milliseconds since some fixed point
+        virtual void start(int msec) = 0;                   // (re)start the frame timer
+        virtual void stop() = 0;
+        virtual bool isActive() const = 0;
+};
+
+
+#endif
+
+// kate: word-wrap off; encoding utf-8; indent-width 4; tab-width 4; line-numbers on; mixed-indent off; remove-trailing-space-save on; replace-tabs-save on; replace-tabs on; space-indent on;
+// vim:set spell et sw=4 ts=4 nowrap cino=l1,cs,U1:
@@ -17,19 +17,25 @@
  */
 #include "amor.h"
 #include "version.h"
+#include "amoreventlog.h"
+#include "amorstartupprofile.h"
+#include "amortrace.h"
 
 #include <KDBusService>
 #include <KAboutData>
 #include <KLocalizedString>
 
 #include <QApplication>
-#include <QDBusConnection>
+#include <QCommandLineParser>
+#include <QScopedPointer>
 
 static const char description[] = I18N_NOOP("KDE creature for your desktop");
 
 
 int main(int argc, char **argv)
 {
+    AmorStartupProfile::profile();
+
     QApplication app(argc, argv);
     KLocalizedString::setApplicationDomain("amor");
 
@@ -56,12 +62,63 @@ int main(int argc, char **argv)
 
     KAboutData::setApplicationData(about);
 
-    KDBusService service(KDBusService::Unique);
+    QCommandLineParser parser;
+    about.setupCommandLine(&parser);
+    QCommandLineOption recordOption(QStringLiteral("record"), i18n("Record the window manager events to <file>."), QStringLiteral("file"));
+    QCommandLineOption replayOption(QStringLiteral("replay"), i18n("Replay the window manager events recorded in <file>, then quit."), QStringLiteral("file"));
+    QCommandLineOption speedOption(QStringLiteral("replay-speed"), i18n("Replay <factor> times as fast as recorded, 0 for no pauses."),
+                                   QStringLiteral("factor"), QStringLiteral("1"));
+    QCommandLineOption profileOption(QStringLiteral("startup-profile"), i18n("Print where the time until the first frame went, then quit."));
+    parser.addOption(profileOption);
+    QCommandLineOption memoryOption(QStringLiteral("memory-report"), i18n("Print the memory used by each theme once all creatures are shown, then quit."));
+    parser.addOption(memoryOption);
+#ifdef AMOR_TRACING
+    QCommandLineOption traceOption(QStringLiteral("trace"), i18n("Write a Chrome trace of the frame work to <file>."), QStringLiteral("file"));
+    parser.addOption(traceOption);
+#endif
+    parser.addOption(recordOption);
+    parser.addOption(replayOption);
+    parser.addOption(speedOption);
+    parser.process(app);
+    about.processCommandLine(&parser);
+    AmorStartupProfile::profile()->setReport(parser.isSet(profileOption));
+    Amor::setMemoryReport(parser.isSet(memoryOption));
+#ifdef AMOR_TRACING
+    if (parser.isSet(traceOption) && !AmorTrace::open(parser.value(traceOption))) {
+        return 1;
+    }
+#endif
+
+    // The service lives until the end of main(), the phase only as long as
+    // it takes to register it.
+    QScopedPointer<KDBusService> service;
+    {
+        AmorStartupProfile::Scope scope("dbus-service");
+        service.reset(new KDBusService(KDBusService::Unique));
+    }
 
     Amor amor;
 
-    QDBusConnection::sessionBus().registerObject(QStringLiteral( "/Amor" ), &amor);
-    return app.exec();
+    AmorEventRecorder recorder;
+    if (parser.isSet(recordOption) && !recorder.open(parser.value(recordOption))) {
+        return 1;
+    }
+
+    AmorEventReplayer replayer;
+    if (parser.isSet(replayOption)) {
+        if (!replayer.open(parser.value(replayOption))) {
+            return 1;
+        }
+        amor.replay(&replayer);
+        QObject::connect(&replayer, &AmorEventReplayer::finished, &app, &QCoreApplication::quit);
+        replayer.start(parser.value(speedOption).toDouble());
+    }
+
+    QObject::connect(service.data(), &KDBusService::activateRequested, &amor, &Amor::slotActivateRequested);
+
+    const int result = app.exec();
+    AmorTrace::close();
+    return result;
 }
 
 
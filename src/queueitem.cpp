@@ -59,19 +59,19 @@ QueueItem::QueueItem(ItemType type, const QString &text, int time)
 }
 
 
-QueueItem::ItemType QueueItem::type()
+QueueItem::ItemType QueueItem::type() const
 {
     return m_type;
 }
 
 
-QString QueueItem::text()
+QString QueueItem::text() const
 {
     return m_text;
 }
 
 
-int QueueItem::time()
+int QueueItem::time() const
 {
     return m_time;
 }
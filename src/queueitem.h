@@ -29,9 +29,9 @@ class QueueItem
 
         QueueItem(ItemType type, const QString &text, int time = -1);
 
-        ItemType type();
-        QString text();
-        int time();
+        ItemType type() const;
+        QString text() const;
+        int time() const;
 
         void setTime(int newTime);
 